@@ -0,0 +1,120 @@
+#include "common.hpp"
+#include "replay.hpp"
+#include "persistence.hpp"
+#include "multideck.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <random>
+
+struct DeckScaleResult
+{
+    uint64_t moveCount;
+    uint64_t legalMoveCount;
+    int maxLegalMoves;
+    int maxRecordLength;
+    uint64_t errorCount;
+    double seconds;
+};
+
+constexpr int SCALE_CHECK_MAX_MOVES = 1000;
+
+static void printDeckScaleLine(const char* name, const DeckScaleResult& result)
+{
+    char line[128];
+    snprintf(line, sizeof(line), "%-14s %10.0f %8.1f %6d %7d %7llu", name, result.moveCount / result.seconds,
+        static_cast<double>(result.legalMoveCount) / result.moveCount, result.maxLegalMoves, result.maxRecordLength,
+        static_cast<unsigned long long>(result.errorCount));
+    std::cout << line << std::endl;
+}
+
+// Random games through the single deck engine, the baseline the two deck variants are measured against
+static DeckScaleResult checkSingleDeckScale(int games)
+{
+    DeckScaleResult result = {};
+    Replay replay;
+    Move moves[MAX_MOVES];
+    char record[V1_MAX_LENGTH];
+    std::mt19937 rng(1);
+    auto startTime = std::chrono::steady_clock::now();
+
+    for (int i = 1; i <= games; i++)
+    {
+        replay.deal(i, RuleVariant::STANDARD_RULES);
+        for (int j = 0; j < SCALE_CHECK_MAX_MOVES && !replay.isGameWon(); j++)
+        {
+            int moveCount = replay.generateMoves(moves);
+            if (moveCount == 0)
+            {
+                break;
+            }
+            result.legalMoveCount += moveCount;
+            result.maxLegalMoves = std::max(result.maxLegalMoves, moveCount);
+            result.errorCount += replay.applyMove(moves[rng() % moveCount]) ? 0 : 1;
+            result.moveCount++;
+        }
+        result.maxRecordLength = std::max(result.maxRecordLength, Persistence::writeRecord(*replay.getBoard(), record));
+    }
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return result;
+}
+
+// Every generated move must apply, and every position must survive a record round trip
+template <class Rules>
+static DeckScaleResult checkMultiDeckScale(int games)
+{
+    DeckScaleResult result = {};
+    MultiDeckBoard<Rules> board;
+    MultiDeckBoard<Rules> readBoard;
+    MultiDeckLogic<Rules> logic(&board);
+    Move moves[MAX_MULTIDECK_MOVES];
+    char record[MULTIDECK_RECORD_LENGTH];
+    char readRecord[MULTIDECK_RECORD_LENGTH];
+    std::mt19937 rng(1);
+    auto startTime = std::chrono::steady_clock::now();
+
+    for (int i = 1; i <= games; i++)
+    {
+        board.dealCards(i);
+        for (int j = 0; j < SCALE_CHECK_MAX_MOVES && !logic.isGameWon(); j++)
+        {
+            int moveCount = logic.generateMoves(moves);
+            if (moveCount == 0)
+            {
+                break;
+            }
+            result.legalMoveCount += moveCount;
+            result.maxLegalMoves = std::max(result.maxLegalMoves, moveCount);
+            result.errorCount += logic.applyMove(moves[rng() % moveCount]) ? 0 : 1;
+            result.moveCount++;
+        }
+
+        int recordLength = MultiDeckPersistence<Rules>::writeRecord(board, record);
+        result.maxRecordLength = std::max(result.maxRecordLength, recordLength);
+        if (!MultiDeckPersistence<Rules>::readRecord(&readBoard, record, recordLength) ||
+            MultiDeckPersistence<Rules>::writeRecord(readBoard, readRecord) != recordLength || memcmp(record, readRecord, recordLength) != 0)
+        {
+            result.errorCount++;
+        }
+    }
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return result;
+}
+
+// Random games in Klondike and in the two deck variants, to see how the engine scales with the deck size, e.g. decks 1000
+int main(int argc, char* argv[])
+{
+    int games = argc > 1 ? atoi(argv[1]) : 1000;
+    games = games > 0 ? games : 1;
+
+    std::cout << games << " random games per variant, at most " << SCALE_CHECK_MAX_MOVES << " moves each" << std::endl;
+    std::cout << "Variant           Moves/s  Avg legal  Max  Record  Errors" << std::endl;
+    DeckScaleResult results[] = { checkSingleDeckScale(games), checkMultiDeckScale<FortyThievesRules>(games), checkMultiDeckScale<SpiderRules>(games) };
+    printDeckScaleLine("Klondike", results[0]);
+    printDeckScaleLine("Forty Thieves", results[1]);
+    printDeckScaleLine("Spider", results[2]);
+    return results[0].errorCount + results[1].errorCount + results[2].errorCount == 0 ? 0 : 1;
+}
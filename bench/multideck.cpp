@@ -0,0 +1,594 @@
+#include "multideck.hpp"
+
+#include <random>
+
+constexpr char MULTIDECK_SEP = 0x7F;
+constexpr int MULTIDECK_FACE_UP = 0x80;
+
+template <class Rules>
+constexpr int MultiDeckBoard<Rules>::CARD_COUNT;
+template <class Rules>
+constexpr int MultiDeckBoard<Rules>::FIRST_FOUNDATION_PILE;
+
+template <class Rules>
+MultiDeckBoard<Rules>::MultiDeckBoard()
+{
+    onNewGame();
+}
+
+template <class Rules>
+void MultiDeckBoard<Rules>::onNewGame()
+{
+    for (int i = 0; i < Rules::STACK_COUNT; i++)
+    {
+        this->stackLengths[i] = 0;
+        this->hiddenCounts[i] = 0;
+    }
+    for (int i = 0; i < Rules::FOUNDATION_COUNT; i++)
+    {
+        this->foundationLengths[i] = 0;
+    }
+    this->stockLength = 0;
+    this->wasteLength = 0;
+    this->moves = 0;
+}
+
+// Shuffled the same way as a single deck, the rest of the deal goes to the stock
+template <class Rules>
+void MultiDeckBoard<Rules>::dealCards(uint32_t seed)
+{
+    onNewGame();
+
+    uint8_t deck[CARD_COUNT];
+    for (int i = 0; i < CARD_COUNT; i++)
+    {
+        deck[i] = i;
+    }
+    std::mt19937 rng(seed);
+    for (int i = CARD_COUNT - 1; i > 0; i--)
+    {
+        int j = rng() % (i + 1);
+        std::swap(deck[i], deck[j]);
+    }
+
+    int cardIndex = 0;
+    for (int i = 0; i < Rules::STACK_COUNT; i++)
+    {
+        for (int j = 0; j < Rules::getDealLength(i); j++)
+        {
+            this->stacks[i][this->stackLengths[i]++] = deck[cardIndex++];
+        }
+        this->hiddenCounts[i] = Rules::DEALS_FACE_UP ? 0 : this->stackLengths[i] - 1;
+    }
+    for (; cardIndex < CARD_COUNT; cardIndex++)
+    {
+        this->stock[this->stockLength++] = deck[cardIndex];
+    }
+}
+
+template <class Rules>
+int MultiDeckBoard<Rules>::getStackLength(int stackIndex) const
+{
+    return this->stackLengths[stackIndex];
+}
+
+template <class Rules>
+int MultiDeckBoard<Rules>::getHiddenCardCount(int stackIndex) const
+{
+    return this->hiddenCounts[stackIndex];
+}
+
+template <class Rules>
+int MultiDeckBoard<Rules>::getCardFromStack(int stackIndex, int cardIndex) const
+{
+    return this->stacks[stackIndex][cardIndex];
+}
+
+template <class Rules>
+int MultiDeckBoard<Rules>::getFoundationLength(int foundationIndex) const
+{
+    return this->foundationLengths[foundationIndex];
+}
+
+template <class Rules>
+int MultiDeckBoard<Rules>::getStockLength() const
+{
+    return this->stockLength;
+}
+
+template <class Rules>
+int MultiDeckBoard<Rules>::getCardFromStock(int cardIndex) const
+{
+    return this->stock[cardIndex];
+}
+
+template <class Rules>
+int MultiDeckBoard<Rules>::getWasteLength() const
+{
+    return this->wasteLength;
+}
+
+template <class Rules>
+int MultiDeckBoard<Rules>::getCardFromWaste(int cardIndex) const
+{
+    return this->waste[cardIndex];
+}
+
+template <class Rules>
+int MultiDeckBoard<Rules>::getMoves() const
+{
+    return this->moves;
+}
+
+template <class Rules>
+void MultiDeckBoard<Rules>::removeCardsFromStack(int stackIndex, int count)
+{
+    this->stackLengths[stackIndex] -= count;
+    if (this->stackLengths[stackIndex] > 0 && this->stackLengths[stackIndex] == this->hiddenCounts[stackIndex])
+    {
+        this->hiddenCounts[stackIndex]--;
+    }
+}
+
+template <class Rules>
+void MultiDeckBoard<Rules>::addCardToStack(int stackIndex, int cardId)
+{
+    this->stacks[stackIndex][this->stackLengths[stackIndex]++] = cardId;
+}
+
+template <class Rules>
+void MultiDeckBoard<Rules>::setHiddenCardCount(int stackIndex, int hiddenCount)
+{
+    this->hiddenCounts[stackIndex] = hiddenCount;
+}
+
+template <class Rules>
+void MultiDeckBoard<Rules>::setFoundationLength(int foundationIndex, int foundationLength)
+{
+    this->foundationLengths[foundationIndex] = foundationLength;
+}
+
+template <class Rules>
+void MultiDeckBoard<Rules>::addCardToStock(int cardId)
+{
+    this->stock[this->stockLength++] = cardId;
+}
+
+template <class Rules>
+int MultiDeckBoard<Rules>::removeCardFromStock()
+{
+    return this->stock[--this->stockLength];
+}
+
+template <class Rules>
+void MultiDeckBoard<Rules>::addCardToWaste(int cardId)
+{
+    this->waste[this->wasteLength++] = cardId;
+}
+
+template <class Rules>
+int MultiDeckBoard<Rules>::removeCardFromWaste()
+{
+    return this->waste[--this->wasteLength];
+}
+
+template <class Rules>
+void MultiDeckBoard<Rules>::setMoves(int moves)
+{
+    this->moves = moves;
+}
+
+template <class Rules>
+void MultiDeckBoard<Rules>::addMoves()
+{
+    this->moves++;
+}
+
+template <class Rules>
+MultiDeckLogic<Rules>::MultiDeckLogic(MultiDeckBoard<Rules>* board)
+{
+    this->board = board;
+}
+
+template <class Rules>
+bool MultiDeckLogic<Rules>::isGameWon()
+{
+    for (int i = 0; i < Rules::FOUNDATION_COUNT; i++)
+    {
+        if (this->board->getFoundationLength(i) != MAX_VALUE)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Moves are always generated in the same order, as for a single deck
+1. Waste to foundation, then stacks to foundations
+2. Waste to stacks
+3. Stacks to stacks, by source stack then run length
+4. Draw (or deal a row)
+*/
+template <class Rules>
+int MultiDeckLogic<Rules>::generateMoves(Move* moves)
+{
+    constexpr int FIRST_FOUNDATION_PILE = MultiDeckBoard<Rules>::FIRST_FOUNDATION_PILE;
+    int moveCount = 0;
+
+    // Both copies of the card each foundation takes next, and every stack top, so a card is checked with one bit test
+    WideCardMask foundationNextCards = { { 0, 0 } };
+    for (int i = 0; Rules::BUILDS_FOUNDATIONS && i < Rules::FOUNDATION_COUNT; i++)
+    {
+        int foundationLength = this->board->getFoundationLength(i);
+        if (foundationLength < MAX_VALUE)
+        {
+            int cardId = (i % SUIT_COUNT) * MAX_VALUE + foundationLength;
+            foundationNextCards = foundationNextCards | wideCardBit(cardId) | wideCardBit(cardId + MAX_CARDS);
+        }
+    }
+
+    int wasteTop = this->board->getWasteLength() > 0 ? this->board->getCardFromWaste(this->board->getWasteLength() - 1) : -1;
+
+    // 1.
+    if (Rules::BUILDS_FOUNDATIONS)
+    {
+        if (wasteTop != -1 && hasCard(foundationNextCards, wasteTop))
+        {
+            moves[moveCount++] = { UNUSED_PILE, static_cast<uint8_t>(FIRST_FOUNDATION_PILE + getFoundationForCard(wasteTop)), 1 };
+        }
+        for (int i = 0; i < Rules::STACK_COUNT; i++)
+        {
+            int stackLength = this->board->getStackLength(i);
+            if (stackLength > 0 && hasCard(foundationNextCards, this->board->getCardFromStack(i, stackLength - 1)))
+            {
+                int foundationIndex = getFoundationForCard(this->board->getCardFromStack(i, stackLength - 1));
+                moves[moveCount++] = { static_cast<uint8_t>(FIRST_STACK_PILE + i), static_cast<uint8_t>(FIRST_FOUNDATION_PILE + foundationIndex), 1 };
+            }
+        }
+    }
+
+    // 2.
+    if (wasteTop != -1)
+    {
+        for (int j = 0; j < Rules::STACK_COUNT; j++)
+        {
+            if (canStackAcceptCard(j, wasteTop))
+            {
+                moves[moveCount++] = { UNUSED_PILE, static_cast<uint8_t>(FIRST_STACK_PILE + j), 1 };
+            }
+        }
+    }
+
+    // 3. Moving a whole stack onto an empty one changes nothing, so it is left out
+    for (int i = 0; i < Rules::STACK_COUNT; i++)
+    {
+        int stackLength = this->board->getStackLength(i);
+        int runLength = getRunLength(i);
+        for (int count = 1; count <= runLength; count++)
+        {
+            int cardId = this->board->getCardFromStack(i, stackLength - count);
+            for (int j = 0; j < Rules::STACK_COUNT; j++)
+            {
+                if (j != i && canStackAcceptCard(j, cardId) && (count < stackLength || this->board->getStackLength(j) > 0))
+                {
+                    moves[moveCount++] = { static_cast<uint8_t>(FIRST_STACK_PILE + i), static_cast<uint8_t>(FIRST_STACK_PILE + j), static_cast<uint8_t>(count) };
+                }
+            }
+        }
+    }
+
+    // 4.
+    if (this->board->getStockLength() > 0 && (Rules::HAS_WASTE || !hasEmptyStack()))
+    {
+        moves[moveCount++] = { UNUSED_PILE, UNUSED_PILE, 1 };
+    }
+
+    return moveCount;
+}
+
+// Headless entry point, the move is validated against the current position
+template <class Rules>
+bool MultiDeckLogic<Rules>::applyMove(const Move& move)
+{
+    constexpr int FIRST_FOUNDATION_PILE = MultiDeckBoard<Rules>::FIRST_FOUNDATION_PILE;
+    constexpr int PILE_COUNT = FIRST_FOUNDATION_PILE + Rules::FOUNDATION_COUNT;
+    MultiDeckBoard<Rules>* board = this->board;
+
+    if (move.from == UNUSED_PILE && move.to == UNUSED_PILE)
+    {
+        if (board->getStockLength() == 0 || (!Rules::HAS_WASTE && hasEmptyStack()))
+        {
+            return false;
+        }
+
+        if (Rules::HAS_WASTE)
+        {
+            board->addCardToWaste(board->removeCardFromStock());
+        }
+        else
+        {
+            // The stock holds whole rows, and a dealt card can complete a run
+            for (int i = 0; i < Rules::STACK_COUNT; i++)
+            {
+                board->addCardToStack(i, board->removeCardFromStock());
+                removeCompletedRun(i);
+            }
+        }
+    }
+    else if (move.from == UNUSED_PILE && move.to < PILE_COUNT)
+    {
+        if (board->getWasteLength() == 0)
+        {
+            return false;
+        }
+
+        int cardId = board->getCardFromWaste(board->getWasteLength() - 1);
+        if (move.to < FIRST_FOUNDATION_PILE && canStackAcceptCard(move.to - FIRST_STACK_PILE, cardId))
+        {
+            board->addCardToStack(move.to - FIRST_STACK_PILE, board->removeCardFromWaste());
+        }
+        else if (move.to >= FIRST_FOUNDATION_PILE && getFoundationForCard(cardId) == move.to - FIRST_FOUNDATION_PILE)
+        {
+            board->removeCardFromWaste();
+            board->setFoundationLength(move.to - FIRST_FOUNDATION_PILE, board->getFoundationLength(move.to - FIRST_FOUNDATION_PILE) + 1);
+        }
+        else
+        {
+            return false;
+        }
+    }
+    else if (move.from >= FIRST_STACK_PILE && move.from < FIRST_FOUNDATION_PILE && move.from != move.to && move.to >= FIRST_STACK_PILE && move.to < PILE_COUNT)
+    {
+        int fromStackIndex = move.from - FIRST_STACK_PILE;
+        int stackLength = board->getStackLength(fromStackIndex);
+        if (move.count < 1 || move.count > getRunLength(fromStackIndex))
+        {
+            return false;
+        }
+
+        int cardIndex = stackLength - move.count;
+        int cardId = board->getCardFromStack(fromStackIndex, cardIndex);
+        if (move.to < FIRST_FOUNDATION_PILE)
+        {
+            int toStackIndex = move.to - FIRST_STACK_PILE;
+            if (!canStackAcceptCard(toStackIndex, cardId))
+            {
+                return false;
+            }
+            for (int i = cardIndex; i < stackLength; i++)
+            {
+                board->addCardToStack(toStackIndex, board->getCardFromStack(fromStackIndex, i));
+            }
+            board->removeCardsFromStack(fromStackIndex, move.count);
+            removeCompletedRun(toStackIndex);
+        }
+        else if (move.count == 1 && getFoundationForCard(cardId) == move.to - FIRST_FOUNDATION_PILE)
+        {
+            board->removeCardsFromStack(fromStackIndex, 1);
+            board->setFoundationLength(move.to - FIRST_FOUNDATION_PILE, board->getFoundationLength(move.to - FIRST_FOUNDATION_PILE) + 1);
+        }
+        else
+        {
+            return false;
+        }
+    }
+    else
+    {
+        return false;
+    }
+
+    board->addMoves();
+    return true;
+}
+
+template <class Rules>
+bool MultiDeckLogic<Rules>::canStackAcceptCard(int stackIndex, int cardId)
+{
+    int stackLength = this->board->getStackLength(stackIndex);
+    if (stackLength == 0)
+    {
+        return true;
+    }
+
+    int topCardId = this->board->getCardFromStack(stackIndex, stackLength - 1);
+    return getMultiDeckCardValue(topCardId) == getMultiDeckCardValue(cardId) + 1 &&
+        (!Rules::BUILDS_IN_SUIT || getMultiDeckCardSuit(topCardId) == getMultiDeckCardSuit(cardId));
+}
+
+// The first foundation of the card's suit that takes it next, -1 if none does
+template <class Rules>
+int MultiDeckLogic<Rules>::getFoundationForCard(int cardId)
+{
+    if (!Rules::BUILDS_FOUNDATIONS)
+    {
+        return -1;
+    }
+
+    for (int i = getMultiDeckCardSuit(cardId); i < Rules::FOUNDATION_COUNT; i += SUIT_COUNT)
+    {
+        if (this->board->getFoundationLength(i) == getMultiDeckCardValue(cardId) - 1)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Cards on top of the stack that may move together
+template <class Rules>
+int MultiDeckLogic<Rules>::getRunLength(int stackIndex)
+{
+    int stackLength = this->board->getStackLength(stackIndex);
+    if (stackLength == 0 || !Rules::MOVES_RUNS)
+    {
+        return stackLength > 0 ? 1 : 0;
+    }
+
+    int runLength = 1;
+    int hiddenCount = this->board->getHiddenCardCount(stackIndex);
+    for (int i = stackLength - 1; i > hiddenCount; i--)
+    {
+        int cardId = this->board->getCardFromStack(stackIndex, i);
+        int belowCardId = this->board->getCardFromStack(stackIndex, i - 1);
+        if (getMultiDeckCardSuit(belowCardId) != getMultiDeckCardSuit(cardId) || getMultiDeckCardValue(belowCardId) != getMultiDeckCardValue(cardId) + 1)
+        {
+            break;
+        }
+        runLength++;
+    }
+    return runLength;
+}
+
+template <class Rules>
+bool MultiDeckLogic<Rules>::hasEmptyStack()
+{
+    for (int i = 0; i < Rules::STACK_COUNT; i++)
+    {
+        if (this->board->getStackLength(i) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// A King to Ace run in one suit goes to the first empty foundation
+template <class Rules>
+void MultiDeckLogic<Rules>::removeCompletedRun(int stackIndex)
+{
+    if (Rules::BUILDS_FOUNDATIONS || getRunLength(stackIndex) < MAX_VALUE)
+    {
+        return;
+    }
+
+    for (int i = 0; i < Rules::FOUNDATION_COUNT; i++)
+    {
+        if (this->board->getFoundationLength(i) == 0)
+        {
+            this->board->removeCardsFromStack(stackIndex, MAX_VALUE);
+            this->board->setFoundationLength(i, MAX_VALUE);
+            return;
+        }
+    }
+}
+
+template <class Rules>
+int MultiDeckPersistence<Rules>::writeRecord(const MultiDeckBoard<Rules>& board, char* record)
+{
+    int recordIndex = 0;
+    for (int i = 0; i < Rules::STACK_COUNT; i++)
+    {
+        for (int j = 0; j < board.getStackLength(i); j++)
+        {
+            record[recordIndex++] = board.getCardFromStack(i, j) | (j >= board.getHiddenCardCount(i) ? MULTIDECK_FACE_UP : 0);
+        }
+        record[recordIndex++] = MULTIDECK_SEP;
+    }
+    for (int i = 0; i < Rules::FOUNDATION_COUNT; i++)
+    {
+        record[recordIndex++] = board.getFoundationLength(i);
+    }
+    for (int i = 0; i < board.getStockLength(); i++)
+    {
+        record[recordIndex++] = board.getCardFromStock(i);
+    }
+    record[recordIndex++] = MULTIDECK_SEP;
+    for (int i = 0; i < board.getWasteLength(); i++)
+    {
+        record[recordIndex++] = board.getCardFromWaste(i);
+    }
+    record[recordIndex++] = MULTIDECK_SEP;
+
+    int moves = board.getMoves() < 0xFFFF ? board.getMoves() : 0xFFFF;
+    record[recordIndex++] = moves >> 8;
+    record[recordIndex++] = moves & 0xFF;
+    return recordIndex;
+}
+
+// Every card must show up exactly once, either as a card or as part of a foundation
+template <class Rules>
+bool MultiDeckPersistence<Rules>::readRecord(MultiDeckBoard<Rules>* board, const char* record, int recordLength)
+{
+    constexpr int CARD_COUNT = MultiDeckBoard<Rules>::CARD_COUNT;
+    board->onNewGame();
+
+    WideCardMask seenCards = { { 0, 0 } };
+    int cardCount = 0;
+    int recordIndex = 0;
+    // Reads cards up to the next separator, returns false on a bad or repeated card
+    auto readCards = [&](int stackIndex) -> bool
+    {
+        int hiddenCount = 0;
+        bool hasFaceUpCard = false;
+        for (; recordIndex < recordLength && record[recordIndex] != MULTIDECK_SEP; recordIndex++)
+        {
+            int cardByte = static_cast<unsigned char>(record[recordIndex]);
+            int cardId = cardByte & ~MULTIDECK_FACE_UP;
+            bool isFaceUp = (cardByte & MULTIDECK_FACE_UP) != 0;
+            if (cardId >= CARD_COUNT || hasCard(seenCards, cardId) || (stackIndex >= 0 && !isFaceUp && hasFaceUpCard))
+            {
+                return false;
+            }
+            seenCards = seenCards | wideCardBit(cardId);
+            cardCount++;
+
+            if (stackIndex == -1)
+            {
+                board->addCardToStock(cardId);
+            }
+            else if (stackIndex == -2)
+            {
+                board->addCardToWaste(cardId);
+            }
+            else
+            {
+                board->addCardToStack(stackIndex, cardId);
+                hiddenCount += isFaceUp ? 0 : 1;
+                hasFaceUpCard = hasFaceUpCard || isFaceUp;
+            }
+        }
+        if (stackIndex >= 0)
+        {
+            board->setHiddenCardCount(stackIndex, hiddenCount);
+        }
+        // Skip the separator
+        return recordIndex++ < recordLength;
+    };
+
+    for (int i = 0; i < Rules::STACK_COUNT; i++)
+    {
+        if (!readCards(i))
+        {
+            return false;
+        }
+    }
+    if (recordIndex + Rules::FOUNDATION_COUNT > recordLength)
+    {
+        return false;
+    }
+    for (int i = 0; i < Rules::FOUNDATION_COUNT; i++)
+    {
+        int foundationLength = record[recordIndex++];
+        if (foundationLength < 0 || foundationLength > MAX_VALUE)
+        {
+            return false;
+        }
+        board->setFoundationLength(i, foundationLength);
+        cardCount += foundationLength;
+    }
+    if (!readCards(-1) || !readCards(-2) || recordIndex + 2 != recordLength || cardCount != CARD_COUNT)
+    {
+        return false;
+    }
+
+    board->setMoves(static_cast<unsigned char>(record[recordIndex]) << 8 | static_cast<unsigned char>(record[recordIndex + 1]));
+    return true;
+}
+
+// Every two deck variant gets its own board, logic and record format
+template class MultiDeckBoard<FortyThievesRules>;
+template class MultiDeckBoard<SpiderRules>;
+template class MultiDeckLogic<FortyThievesRules>;
+template class MultiDeckLogic<SpiderRules>;
+template class MultiDeckPersistence<FortyThievesRules>;
+template class MultiDeckPersistence<SpiderRules>;
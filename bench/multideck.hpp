@@ -0,0 +1,174 @@
+#pragma once
+
+#include <cstdint>
+
+#include "common.hpp"
+#include "move.hpp"
+
+constexpr int MAX_DECK_COUNT = 2;
+constexpr int MAX_MULTIDECK_CARDS = MAX_DECK_COUNT * MAX_CARDS;
+// Upper bound of legal moves in any position, runs of any length make Spider the widest
+constexpr int MAX_MULTIDECK_MOVES = 1024;
+// One byte per card, a separator after every stack, the stock and the waste, a byte per foundation and the moves
+constexpr int MULTIDECK_RECORD_LENGTH = 128;
+
+/*
+Two decks need 104 bits, so a wide mask spans two words
+Card id 52 * deckIndex + single deck card id, so value and suit follow from cardId % 52
+*/
+struct WideCardMask
+{
+    uint64_t words[2];
+};
+
+inline WideCardMask wideCardBit(int cardId)
+{
+    WideCardMask mask = { { 0, 0 } };
+    mask.words[cardId >> 6] = static_cast<uint64_t>(1) << (cardId & 63);
+    return mask;
+}
+
+inline WideCardMask operator|(const WideCardMask& a, const WideCardMask& b)
+{
+    return { { a.words[0] | b.words[0], a.words[1] | b.words[1] } };
+}
+
+inline bool hasCard(const WideCardMask& mask, int cardId)
+{
+    return (mask.words[cardId >> 6] >> (cardId & 63)) & 1;
+}
+
+constexpr int getMultiDeckCardValue(int cardId)
+{
+    return cardId % MAX_VALUE + 1;
+}
+
+constexpr int getMultiDeckCardSuit(int cardId)
+{
+    return cardId % MAX_CARDS / MAX_VALUE;
+}
+
+/*
+Two deck variants, every rule is a compile time constant like the Klondike rule policies
+Cards are ids (52 * deckIndex + single deck card id), so both copies of a card are distinct
+Piles as seen by a move: the stock (and waste) is pile 0, then the stacks, then the foundations
+
+This engine is not part of the game: the display, saves and archive are Klondike only
+It is built with its one user, the deck scale benchmark (decks.cpp), by make bench
+*/
+struct FortyThievesRules
+{
+    static constexpr int DECK_COUNT = 2;
+    static constexpr int STACK_COUNT = 10;
+    static constexpr int FOUNDATION_COUNT = 8;
+    // Four rows, all face up
+    static constexpr int getDealLength(int) { return 4; }
+    static constexpr bool DEALS_FACE_UP = true;
+
+    // Stacks build down in suit, one card at a time, and an empty stack takes any card
+    static constexpr bool BUILDS_IN_SUIT = true;
+    static constexpr bool MOVES_RUNS = false;
+    // The stock turns one card at a time onto the waste, with no redeal
+    static constexpr bool HAS_WASTE = true;
+    // Foundations build up in suit card by card
+    static constexpr bool BUILDS_FOUNDATIONS = true;
+};
+
+struct SpiderRules
+{
+    static constexpr int DECK_COUNT = 2;
+    static constexpr int STACK_COUNT = 10;
+    static constexpr int FOUNDATION_COUNT = 8;
+    // 54 cards, only the top card of each stack face up
+    static constexpr int getDealLength(int stackIndex) { return stackIndex < 4 ? 6 : 5; }
+    static constexpr bool DEALS_FACE_UP = false;
+
+    // Stacks build down regardless of suit, but only runs in one suit move together
+    static constexpr bool BUILDS_IN_SUIT = false;
+    static constexpr bool MOVES_RUNS = true;
+    // The stock deals one card onto every stack, only while no stack is empty
+    static constexpr bool HAS_WASTE = false;
+    // A full King to Ace run in one suit leaves the stacks as a whole
+    static constexpr bool BUILDS_FOUNDATIONS = false;
+};
+
+template <class Rules>
+class MultiDeckBoard
+{
+public:
+    static constexpr int CARD_COUNT = Rules::DECK_COUNT * MAX_CARDS;
+    static constexpr int FIRST_FOUNDATION_PILE = FIRST_STACK_PILE + Rules::STACK_COUNT;
+
+    MultiDeckBoard();
+
+    void onNewGame();
+    void dealCards(uint32_t);
+
+    int getStackLength(int) const;
+    int getHiddenCardCount(int) const;
+    int getCardFromStack(int, int) const;
+    int getFoundationLength(int) const;
+    int getStockLength() const;
+    int getCardFromStock(int) const;
+    int getWasteLength() const;
+    int getCardFromWaste(int) const;
+    int getMoves() const;
+
+    // Flips the new top card if it is face down
+    void removeCardsFromStack(int, int);
+    void addCardToStack(int, int);
+    void setHiddenCardCount(int, int);
+    void setFoundationLength(int, int);
+    void addCardToStock(int);
+    int removeCardFromStock();
+    void addCardToWaste(int);
+    int removeCardFromWaste();
+    void setMoves(int);
+    void addMoves();
+
+private:
+    // A stack never holds more than every card
+    uint8_t stacks[Rules::STACK_COUNT][CARD_COUNT];
+    int stackLengths[Rules::STACK_COUNT];
+    int hiddenCounts[Rules::STACK_COUNT];
+    int foundationLengths[Rules::FOUNDATION_COUNT];
+    // The top of the stock is its last card
+    uint8_t stock[CARD_COUNT];
+    int stockLength;
+    uint8_t waste[CARD_COUNT];
+    int wasteLength;
+    int moves;
+};
+
+template <class Rules>
+class MultiDeckLogic
+{
+public:
+    MultiDeckLogic(MultiDeckBoard<Rules>*);
+
+    bool isGameWon();
+    int generateMoves(Move*);
+    bool applyMove(const Move&);
+
+private:
+    MultiDeckBoard<Rules>* board = nullptr;
+
+    bool canStackAcceptCard(int, int);
+    int getFoundationForCard(int);
+    int getRunLength(int);
+    bool hasEmptyStack();
+    void removeCompletedRun(int);
+};
+
+/*
+A position as a record of at most MULTIDECK_RECORD_LENGTH bytes, the two deck counterpart of a v1 save body
+Cards take 7 bits, the high bit marks a face up card
+Stacks[Cards SEP] Foundation Lengths[1 each] Stock[Cards SEP] Waste[Cards SEP] Moves[2]
+*/
+template <class Rules>
+class MultiDeckPersistence
+{
+public:
+    static int writeRecord(const MultiDeckBoard<Rules>&, char*);
+    static bool readRecord(MultiDeckBoard<Rules>*, const char*, int);
+};
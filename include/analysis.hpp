@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "common.hpp"
+#include "move.hpp"
+#include "board.hpp"
+#include "rules.hpp"
+
+// How often the input loop checks for a hint that is still being worked out
+constexpr int ANALYSIS_POLL_INTERVAL_MS = 50;
+// Positions searched for one hint, deeper searches stop once it is spent
+constexpr int ANALYSIS_NODE_BUDGET = 300000;
+constexpr int ANALYSIS_MAX_DEPTH = 12;
+// Positions searched between checks for a cancelled analysis
+constexpr int ANALYSIS_CANCEL_INTERVAL = 256;
+
+// Higher is better, only meant to compare positions of the same game
+int scorePosition(const Board&);
+
+/*
+Depth by depth search of the lines from a position, within a budget of positions
+Lines are scored by the cards on the foundations, and the face down and undealt cards left, a won line beats every other
+The best line is the best line of the last depth searched in full
+*/
+class MoveSearch
+{
+public:
+    MoveSearch();
+
+    // Returns false if cancelled before a depth was searched in full, hasMove is false if there are no moves
+    bool findBestMove(const Board&, const RuleSet*, int, Move*, bool*);
+    // Score of the best line, or of the position itself if cancelled before a depth was searched in full
+    int scoreBestLine(const Board&, const RuleSet*, int);
+    // The search stops once the generation is no longer the given one
+    void setCancelGeneration(const std::atomic<uint64_t>*, uint64_t);
+
+private:
+    vector<Board> boards;
+    int nodeCount;
+    int nodeBudget;
+    const std::atomic<uint64_t>* generation = nullptr;
+    uint64_t searchGeneration;
+
+    int searchDeepening(const Board&, const RuleSet*, int, Move*);
+    int searchDepth(int, int, const RuleSet*, Move*);
+    bool getIsCancelled();
+};
+
+// The position to analyse, copied on the input thread and never changed afterwards
+struct AnalysisSnapshot
+{
+    Board board;
+    RuleVariant ruleVariant;
+    uint64_t generation;
+};
+
+/*
+Finds the best move of a position on a background thread, so a hint is usually ready before it is asked for
+The hint is the first move of the best line MoveSearch finds
+
+Every request or cancel starts a new generation. The worker checks the generation as it searches,
+and drops its work as soon as the position it is searching is no longer the current one
+*/
+class AnalysisWorker
+{
+public:
+    AnalysisWorker();
+    ~AnalysisWorker();
+
+    void requestAnalysis(const Board&, RuleVariant);
+    void cancel();
+    // Returns true once the hint of the current position is ready, hasMove is false if there are no moves left
+    bool pollHint(Move*, bool*);
+    bool getIsBusy();
+
+private:
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::atomic<uint64_t> generation;
+
+    // Guarded by the mutex
+    AnalysisSnapshot pendingSnapshot;
+    bool hasPendingSnapshot;
+    bool isSearching;
+    uint64_t resultGeneration;
+    Move resultMove;
+    bool resultHasMove;
+    bool isStopping;
+
+    // Only used by the worker thread
+    AnalysisSnapshot searchSnapshot;
+    MoveSearch search;
+
+    void run();
+};
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+
+#include "common.hpp"
+#include "history.hpp"
+
+class GameCodec;
+
+constexpr char ARCHIVE_NAME[] = "games.arc";
+constexpr int ARCHIVE_VERSION = 6;
+// Records are buffered and written one block at a time
+constexpr int ARCHIVE_BLOCK_RECORDS = 4096;
+constexpr int ARCHIVE_BLOCK_HEADER_LENGTH = 16;
+// Block index entry count, version and magic
+constexpr int ARCHIVE_TRAILER_LENGTH = 4 + 4 + 4;
+
+enum GameResult
+{
+    ABANDONED,
+    WON
+};
+
+// seed is the game's deal, or 0 if it is unknown
+struct GameRecord
+{
+    uint32_t seed;
+    GameResult result;
+    uint32_t moveCount;
+    uint32_t durationMs;
+    RuleVariant ruleVariant;
+    const MoveHistory* history;
+};
+
+struct ArchiveBlockInfo
+{
+    uint64_t offset;
+    uint32_t recordCount;
+    uint32_t movesLength;
+};
+
+static_assert(sizeof(ArchiveBlockInfo) == 16, "Block index entries are packed without padding");
+
+/*
+Columns of one block, pointing straight into the mapped archive
+Record i's moves are moves[moveOffsets[i]] up to moveOffsets[i + 1], or movesLength for the last record
+They are coded with GameCodec if the seed is known, and as a MoveHistory otherwise
+A seed is only stored for moves that replay from the deal, the deal itself is kept either way
+*/
+struct ArchiveBlock
+{
+    int recordCount;
+    const uint32_t* seeds;
+    const uint32_t* moveCounts;
+    const uint32_t* durations;
+    const uint32_t* moveOffsets;
+    const uint8_t* results;
+    const uint8_t* ruleVariants;
+    // 52 card bytes per record, in deal order (Persistence::writeCardData), all SEPs if the deal is unknown
+    const char* deals;
+    const char* moves;
+    uint32_t movesLength;
+};
+
+/*
+Columnar archive of finished games
+Block: Header[16] Seeds[4n] Move Counts[4n] Durations[4n] Move Offsets[4n] Results[n] Rule Variants[n] Deals[52n] Moves[m] Padding
+Block header: Magic[4] Record Count[4] Moves Length[4] Version[4]
+Footer: Block Infos[16 * blocks] Block Count[4] Version[4] Magic[4]
+
+Wider columns come first and blocks are padded to 8 bytes, so every column and the footer can be read in place
+Numbers are in host byte order, the archive is meant to be scanned on the machine that wrote it
+Records are buffered until a block is full, a flush writes the partial block and the footer without ending the block
+Later flushes write that block again in place, so flushing after every game does not cost a block per game
+A missing footer is rebuilt from the block headers
+*/
+class ArchiveWriter
+{
+public:
+    ArchiveWriter();
+    ~ArchiveWriter();
+
+    bool open(const char*);
+    void append(const GameRecord&);
+    bool flush();
+    void close();
+
+private:
+    FILE* file = nullptr;
+    // Where the footer starts, blocks are appended from here
+    uint64_t dataLength;
+    vector<ArchiveBlockInfo> blockInfos;
+
+    int recordCount;
+    vector<uint32_t> seeds;
+    vector<uint32_t> moveCounts;
+    vector<uint32_t> durations;
+    vector<uint32_t> moveOffsets;
+    vector<uint8_t> results;
+    vector<uint8_t> ruleVariants;
+    vector<char> deals;
+    vector<char> moves;
+
+    GameCodec* codec = nullptr;
+    vector<Move> recordMoves;
+    vector<char> recordData;
+
+    bool readIndex();
+    void clearBlock();
+};
+
+class ArchiveReader
+{
+public:
+    ArchiveReader();
+    ~ArchiveReader();
+
+    bool open(const char*);
+    void close();
+
+    int getBlockCount();
+    uint64_t getRecordCount();
+    ArchiveBlock getBlock(int);
+
+    void countWinsByMoveCount(uint32_t, vector<uint64_t>*, vector<uint64_t>*);
+
+private:
+    const char* data = nullptr;
+    uint64_t dataLength;
+    const ArchiveBlockInfo* blockInfos = nullptr;
+    int blockCount;
+#ifdef _WIN32
+    vector<char> buffer;
+#endif
+};
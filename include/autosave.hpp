@@ -0,0 +1,70 @@
+#pragma once
+
+#include <chrono>
+
+#include "common.hpp"
+#include "history.hpp"
+#include "persistence.hpp"
+#include "saveworker.hpp"
+
+class Logic;
+
+constexpr char AUTOSAVE_SNAPSHOT_NAME[] = "autosave.sol";
+constexpr char AUTOSAVE_JOURNAL_NAME[] = "autosave.jnl";
+constexpr char AUTOSAVE_JOURNAL_TEMP_NAME[] = "autosave.jnl.tmp";
+
+// Journal header: Magic[4] Snapshot CRC32[4]
+constexpr int JOURNAL_MAGIC_LENGTH = 4;
+constexpr int JOURNAL_HEADER_LENGTH = JOURNAL_MAGIC_LENGTH + 4;
+
+// Moves are group committed once this many are pending, or when the oldest has waited for the interval
+constexpr int JOURNAL_COMMIT_MOVES = 8;
+constexpr int JOURNAL_COMMIT_INTERVAL_MS = 1000;
+// The journal is folded into a new snapshot after this many moves
+constexpr int JOURNAL_COMPACT_MOVES = 256;
+
+/*
+Crash safe autosave
+The snapshot is a v2 save file, the journal holds the encoded moves made after it
+On startup the journal is replayed onto the snapshot, a torn or invalid tail is dropped
+Snapshots are written on a SaveWorker, moves made meanwhile wait in memory until the new journal is in place
+*/
+class Autosave
+{
+public:
+    Autosave(MoveHistory*, Persistence*, Logic*);
+    ~Autosave();
+
+    bool recover();
+    void onNewGame();
+    void update();
+    void stop();
+    void discard();
+
+    // Milliseconds until the pending moves must be committed or a snapshot checked on, -1 if there is nothing to do
+    int getCommitDelay();
+
+private:
+    MoveHistory* history = nullptr;
+    Persistence* persistence = nullptr;
+    Logic* logic = nullptr;
+    SaveWorker* saveWorker = nullptr;
+
+    FILE* journalFile = nullptr;
+    // A snapshot is being written, the journal is opened once it is done
+    bool isCompacting;
+    // Moves of the history that are already in the snapshot or the journal buffer
+    int historyIndex;
+    int journalMoveCount;
+
+    vector<char> pendingData;
+    int pendingMoveCount;
+    std::chrono::steady_clock::time_point pendingSince;
+
+    bool commit();
+    void compact();
+    void finishCompaction(bool);
+    bool replayJournal();
+
+    static bool startJournal(uint32_t);
+};
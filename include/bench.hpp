@@ -0,0 +1,12 @@
+#pragma once
+
+#include "common.hpp"
+
+/*
+Command line benchmarks of the engines, run without the game
+Each prints its report and returns the exit code, non zero if a check failed on the way
+The two deck engine is not part of the game, its benchmark is built on its own by make bench (bench/decks.cpp)
+*/
+
+// LockstepSimulator against the same playouts through Board, the variant must not be a Vegas one
+int printLockstep(int, RuleVariant);
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "common.hpp"
+#include "cardmask.hpp"
+#include "move.hpp"
+#include "board.hpp"
+
+// Position as card masks, enough to generate every legal move without touching the Board piles
+struct Bitboard
+{
+    // Face up cards of each stack
+    CardMask stackCards[STACK_COUNT];
+    // Card id of each stack top, -1 if the stack is empty
+    int stackTops[STACK_COUNT];
+    CardMask stackTopCards;
+    bool hasEmptyStack;
+
+    // Card id of the top of the waste, -1 if the waste is empty
+    int wasteTop;
+    bool hasStockCards;
+    int redealCount;
+
+    CardMask foundationTopCards;
+    // The card each foundation accepts next, Aces for empty foundations
+    CardMask foundationNextCards;
+
+    void update(Board*);
+
+    // Cards that are available to move onto a non-empty stack
+    CardMask getPlaceableCards() const;
+    template <class Rules>
+    bool canStackAcceptCard(int, int) const;
+
+    // Fills the given array (MAX_MOVES long) and returns the number of legal moves under the rule policy
+    template <class Rules>
+    int generateMoves(Move*) const;
+};
+
+inline int popLowestCard(CardMask* mask)
+{
+    int cardId = __builtin_ctzll(*mask);
+    *mask &= *mask - 1;
+    return cardId;
+}
@@ -1,46 +1,82 @@
 #pragma once
 
 #include "common.hpp"
+#include "cardmask.hpp"
 
 class Board
 {
 public:
     Board();
-    ~Board();
 
-    void cleanup();
     void onNewGame();
+    void dealCards(uint32_t);
     void distributeCards(Card* [MAX_CARDS]);
-
-    void flipTopStackCards();
+    static void shuffleDeck(uint32_t, Card* [MAX_CARDS]);
 
     void addCardToStack(int, Card*);
+    void addHiddenCardToStack(int, Card*);
     Card* removeCardFromStack(int);
     void addCardToFoundation(int, Card*);
     Card* removeCardFromFoundation(int);
     Card* removeUnusedCard();
 
-    int getStackLength(int);
-    int getFoundationLength(int);
+    int getStackLength(int) const;
+    int getHiddenCardCount(int) const;
+    CardMask getStackCardMask(int) const;
+    int getFoundationLength(int) const;
 
-    Card* getCardFromStack(int, int);
-    Card* getCardFromFoundation(int, int);
+    Card* getCardFromStack(int, int) const;
+    Card* getCardFromFoundation(int, int) const;
 
-    Card* getCurrentUnusedCard();
-    Card* getNextUnusedCard();
+    Card* getCurrentUnusedCard() const;
+    Card* getNextUnusedCard() const;
     Card* shiftNextUnusedCard();
-    int getRemainingUnusedCardCount();
+    int getRemainingUnusedCardCount() const;
+    int getRedealCount() const;
+    void setRedealCount(int);
+    int getWasteLength() const;
+    Card* getCardFromWaste(int) const;
+    Card* getCardFromStock(int) const;
+
+    RuleVariant getRuleVariant() const;
+    // Also sets the draw count of the variant
+    void setRuleVariant(RuleVariant);
+    int getDrawCount() const;
+
+    uint32_t getSeed() const;
+    void setSeed(uint32_t);
 
-    int getMoves();
+    int getMoves() const;
     void addMoves();
 
     bool loadUnusedCards(Card**, int, int);
     
 private:
     int moves;
-    int unusedCardIndex;
+    // Seed of the deal, 0 if unknown (e.g. loaded from a v1 save)
+    uint32_t seed;
+    // Kept through new games, like the seed generator of a player
+    RuleVariant ruleVariant = RuleVariant::STANDARD_RULES;
+    int drawCount = DEFAULT_DRAW_COUNT;
+
+    // All piles have a fixed capacity, so a new game only resets the lengths
+    Card* stacks[STACK_COUNT][MAX_STACK_LENGTH];
+    int stackLengths[STACK_COUNT];
+    // Face down cards are always at the bottom of a stack
+    int hiddenCounts[STACK_COUNT];
+    // Face up cards of each stack
+    CardMask stackMasks[STACK_COUNT];
+
+    Card* foundations[FOUNDATION_COUNT][MAX_VALUE];
+    int foundationLengths[FOUNDATION_COUNT];
 
-    vector<Card*>* stacks[STACK_COUNT];
-    vector<Card*>* foundations[FOUNDATION_COUNT];
-    vector<Card*>* unusedCards;
+    // The stock and the waste each own one buffer and swap them when the waste is recycled
+    Card* unusedCards[2][RESERVED_CARDS];
+    int stockBuffer;
+    int stockLength;
+    // Cards before stockIndex have already been drawn onto the waste
+    int stockIndex;
+    int wasteLength;
+    // How often the waste was turned back into the stock
+    int redealCount;
 };
\ No newline at end of file
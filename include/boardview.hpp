@@ -0,0 +1,58 @@
+#pragma once
+
+#include "common.hpp"
+#include "board.hpp"
+
+struct PileView
+{
+    /*
+    Unused pile: Remaining (face down) unused cards
+    Stack: Face down cards at the bottom of the stack
+    Foundation: Always 0
+    */
+    int hiddenCount = 0;
+    int visibleCount = 0;
+    // Stacks only, bottom to top, only the first hiddenCount entries are valid
+    Card* hiddenCards[STACK_COUNT - 1] = { nullptr };
+    // Stacks only, rows the face down cards are drawn on: 1 for all of them, or 1 each in thoughtful mode
+    int hiddenRowCount = 0;
+    // Bottom to top, only the first visibleCount entries are valid
+    Card* visibleCards[MAX_STACK_LENGTH] = { nullptr };
+    Card* topCard = nullptr;
+
+    // Cursor extents, -1 to -1 for an empty pile
+    int minCursorIndex = -1;
+    int maxCursorIndex = -1;
+    int yHeight = 3;
+};
+
+// Read-only snapshot of the board, rebuilt once per state change and shared by Cursor, Display and Logic
+class BoardView
+{
+public:
+    BoardView();
+
+    void update(Board*);
+    void setIsThoughtful(bool);
+    bool getIsThoughtful() const;
+
+    // Column as seen by the cursor: 0 unused pile, 1 to 7 stacks, 8 and 9 foundation columns
+    const PileView& getColumn(int) const;
+    const PileView& getStack(int) const;
+    const PileView& getFoundation(int) const;
+
+    bool hasNextUnusedCard() const;
+    int getMoves() const;
+
+private:
+    int moves;
+    bool hasNextUnused;
+    bool isThoughtful;
+
+    PileView columns[COL_COUNT];
+    PileView foundations[FOUNDATION_COUNT];
+
+    void updateUnusedPile(Board*);
+    void updateStack(Board*, int);
+    void updateFoundation(Board*, int);
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "common.hpp"
+#include "rules.hpp"
+#include "session.hpp"
+
+// Input is read in chunks of this size, every complete line in a chunk is one batch
+constexpr int BOT_READ_LENGTH = 65536;
+
+/*
+One game played over stdin and stdout instead of the display, for programs rather than players
+Takes the GameSession commands (deal, play, moves, state, undo) and quit, one per line
+Each command gets one "ok ..." or "err <reason>" line back, in order
+
+Commands may be written many at a time, the responses to everything read at once are written with a single flush
+*/
+class BotPipe
+{
+public:
+    BotPipe(RuleVariant);
+
+    // Plays until quit or the end of the input, returns the exit code
+    int run();
+
+private:
+    GameSession session;
+    string input;
+    string output;
+
+    bool handleLine(const string&);
+    bool writeOutput();
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+#include "common.hpp"
+#include "board.hpp"
+
+/*
+Stacks are only told apart by their cards, so positions that differ only in the order of the stacks play the same
+The canonical form writes the stacks sorted by their content, so every such position, and every choice of empty stack, has one key
+Keys only tell apart positions of the same deal: The stock and the waste keep the deal order, so their lengths stand for their cards
+*/
+
+// Each stack is its face down count, its cards and an end marker, then the foundation lengths, the waste, stock and redeal counts
+constexpr int CANONICAL_KEY_LENGTH = STACK_COUNT * (MAX_STACK_LENGTH + 2) + FOUNDATION_COUNT + 3;
+
+// Stack indices in canonical order
+void getCanonicalStackOrder(const Board&, int[STACK_COUNT]);
+// Returns the key length, at most CANONICAL_KEY_LENGTH
+int writeCanonicalKey(const Board&, uint8_t*);
+uint64_t hashCanonicalPosition(const Board&);
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+
+#include "common.hpp"
+
+// One bit per card id (13 * suitIndex + (value - 1))
+typedef uint64_t CardMask;
+
+constexpr CardMask cardBit(int cardId)
+{
+    return static_cast<CardMask>(1) << cardId;
+}
+
+constexpr int getCardIdValue(int cardId)
+{
+    return cardId % MAX_VALUE + 1;
+}
+
+constexpr int getCardIdSuit(int cardId)
+{
+    return cardId / MAX_VALUE;
+}
+
+constexpr bool isRedSuit(int suit)
+{
+    return suit == Suit::DIAMONDS || suit == Suit::HEARTS;
+}
+
+// Every card of one value, i.e. Aces for value 1
+constexpr CardMask valueMask(int value)
+{
+    return cardBit(Suit::DIAMONDS * MAX_VALUE + value - 1) | cardBit(Suit::CLUBS * MAX_VALUE + value - 1) |
+        cardBit(Suit::HEARTS * MAX_VALUE + value - 1) | cardBit(Suit::SPADES * MAX_VALUE + value - 1);
+}
+
+// Tableau cards that cardId can be placed on: one value higher and of the opposite color
+constexpr CardMask tableauAcceptors(int cardId)
+{
+    return getCardIdValue(cardId) == MAX_VALUE ? 0 :
+        isRedSuit(getCardIdSuit(cardId)) ?
+            cardBit(Suit::CLUBS * MAX_VALUE + getCardIdValue(cardId)) | cardBit(Suit::SPADES * MAX_VALUE + getCardIdValue(cardId)) :
+            cardBit(Suit::DIAMONDS * MAX_VALUE + getCardIdValue(cardId)) | cardBit(Suit::HEARTS * MAX_VALUE + getCardIdValue(cardId));
+}
+
+// Foundation top cards that cardId can be placed on: one value lower and of the same suit
+constexpr CardMask foundationAcceptors(int cardId)
+{
+    return getCardIdValue(cardId) == 1 ? 0 : cardBit(cardId - 1);
+}
+
+// Compile time index list, so each table can be expanded from its generator
+template <int... CardIds>
+struct CardIdList {};
+
+template <int N, int... CardIds>
+struct MakeCardIdList : MakeCardIdList<N - 1, N - 1, CardIds...> {};
+
+template <int... CardIds>
+struct MakeCardIdList<0, CardIds...>
+{
+    typedef CardIdList<CardIds...> type;
+};
+
+template <typename>
+struct CardTables;
+
+template <int... CardIds>
+struct CardTables<CardIdList<CardIds...>>
+{
+    static constexpr CardMask tableau[MAX_CARDS] = { tableauAcceptors(CardIds)... };
+    static constexpr CardMask foundation[MAX_CARDS] = { foundationAcceptors(CardIds)... };
+};
+
+template <int... CardIds>
+constexpr CardMask CardTables<CardIdList<CardIds...>>::tableau[MAX_CARDS];
+
+template <int... CardIds>
+constexpr CardMask CardTables<CardIdList<CardIds...>>::foundation[MAX_CARDS];
+
+typedef CardTables<MakeCardIdList<MAX_CARDS>::type> CompatibilityTables;
+
+// Which cards can accept card c is a single mask lookup
+constexpr const CardMask* TABLEAU_ACCEPTORS = CompatibilityTables::tableau;
+constexpr const CardMask* FOUNDATION_ACCEPTORS = CompatibilityTables::foundation;
+
+constexpr CardMask ALL_CARDS = (static_cast<CardMask>(1) << MAX_CARDS) - 1;
+constexpr CardMask ACE_CARDS = valueMask(1);
+constexpr CardMask KING_CARDS = valueMask(MAX_VALUE);
+constexpr CardMask DIAMOND_CARDS = (static_cast<CardMask>(1) << MAX_VALUE) - 1;
+
+/*
+Cards that can be placed on any of the given tableau cards, without a table lookup per card
+Moving down one value within a suit is a shift by 1, and since the suits alternate in color,
+a shift by 13 reaches the neighbouring suits and a shift by 39 connects Diamonds and Spades
+*/
+constexpr CardMask getTableauChildren(CardMask parents)
+{
+    return (((parents & ~ACE_CARDS) >> 1) << MAX_VALUE |
+        ((parents & ~ACE_CARDS) >> 1) >> MAX_VALUE |
+        (((parents & ~ACE_CARDS) >> 1) & DIAMOND_CARDS) << (3 * MAX_VALUE) |
+        ((parents & ~ACE_CARDS) >> 1) >> (3 * MAX_VALUE)) & ALL_CARDS;
+}
+
+static_assert(TABLEAU_ACCEPTORS[Suit::HEARTS * MAX_VALUE + 4] == (cardBit(Suit::CLUBS * MAX_VALUE + 5) | cardBit(Suit::SPADES * MAX_VALUE + 5)), "5H goes on 6C or 6S");
+static_assert(TABLEAU_ACCEPTORS[Suit::SPADES * MAX_VALUE + 12] == 0, "Kings only go on empty stacks");
+static_assert(FOUNDATION_ACCEPTORS[Suit::CLUBS * MAX_VALUE + 1] == cardBit(Suit::CLUBS * MAX_VALUE), "2C goes on AC");
+static_assert(FOUNDATION_ACCEPTORS[Suit::DIAMONDS * MAX_VALUE] == 0, "Aces only go on empty foundations");
+static_assert(getTableauChildren(cardBit(Suit::SPADES * MAX_VALUE + 5)) == (cardBit(Suit::DIAMONDS * MAX_VALUE + 4) | cardBit(Suit::HEARTS * MAX_VALUE + 4)), "5D and 5H go on 6S");
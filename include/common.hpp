@@ -40,10 +40,15 @@ constexpr int MAX_VALUE = 13;
 constexpr int STACK_COUNT = 7;
 constexpr int FOUNDATION_COUNT = 4;
 constexpr int RESERVED_CARDS = 24;
+constexpr int DEFAULT_DRAW_COUNT = 1;
+// 6 hidden cards under a full King to Ace run
+constexpr int MAX_STACK_LENGTH = STACK_COUNT - 1 + MAX_VALUE;
 
 constexpr int COL_COUNT = 1 + STACK_COUNT + 2;
 
 constexpr int HEIGHT = 22; //1+1+(3+13+1)+1+1+1
+// Thoughtful mode shows the up to 6 face down cards of a stack on a row each, instead of 1 row for all of them
+constexpr int THOUGHTFUL_HEIGHT = HEIGHT + STACK_COUNT - 2;
 constexpr int MIN_WIDTH = 76; //MIN_WIDTH+(2+5)
 constexpr int COL_WIDTH = 7;
 
@@ -85,16 +90,31 @@ enum GameState
     MAIN_MENU,
     GAME_MENU,
     INFO_PAGE,
-    PLAYING
+    PLAYING,
+    SLOT_BROWSER,
+    REPLAY_VIEWER
 };
 
+// Klondike variants, see rules.hpp for their rules. Saved as a byte, so the order must not change
+enum RuleVariant
+{
+    STANDARD_RULES,
+    DRAW_THREE_RULES,
+    VEGAS_RULES,
+    VEGAS_DRAW_THREE_RULES,
+    RULE_VARIANT_COUNT
+};
+
+// Cards are immutable, whether a card is face up depends on where it lies on the Board
 struct Card
 {
     Suit suit;
     int value;
-    bool isFaceUp;
 };
 
+// Allocated once, ordered by card id (13 * suitIndex + (value - 1))
+extern Card DECK[MAX_CARDS];
+
 struct ColorRange
 {
     ColorPair color;
@@ -107,4 +127,9 @@ void monoColorPrint(ColorPair, int, int, string);
 // Prints text in multiple colors
 void multiColorPrint(int, int, string, int, ColorRange*);
 string formatString(string, size_t, string[]);
-bool isRed(Suit);
\ No newline at end of file
+bool isRed(Suit);
+
+inline int getCardId(const Card* card)
+{
+    return static_cast<int>(card - DECK);
+}
\ No newline at end of file
@@ -2,7 +2,7 @@
 
 #include "common.hpp"
 
-#include "board.hpp"
+#include "boardview.hpp"
 
 struct CursorPileInfo
 {
@@ -14,6 +14,8 @@ struct CursorPileInfo
     Foundation: Always False
     */
     bool hasHiddenCard = false;
+    // Stacks only, rows between the top of the pile and the divider above the first visible card
+    int hiddenRowCount = 0;
     
     /*
     Unused Pile: 0 or 1
@@ -29,7 +31,7 @@ struct CursorPileInfo
 class Cursor
 {
 public:
-    Cursor(Board*);
+    Cursor(const BoardView*);
 
     void onNewGame();
 
@@ -43,9 +45,10 @@ public:
     int getHorizCursorXIndex();
     int getVerticalCursorIndex();
     int getLockedCursorPileIndex();
+    int getLockedVerticalCursorIndex();
 
 private:
-    Board* board = nullptr;
+    const BoardView* view = nullptr;
 
     int horizCursorXIndex;
     // If true, then when we change horizCursorXIndex, we do not also change the stackIndex
@@ -4,6 +4,9 @@
 #include "game.hpp"
 #include "cursor.hpp"
 #include "info.hpp"
+#include "slotbrowser.hpp"
+
+class ReplayViewer;
 
 constexpr int MSG_STARTING_X = 2;
 constexpr int MOVE_MSG_STARTING_X = 62;
@@ -11,6 +14,7 @@ constexpr int MAX_MSG_LENGTH = 56;
 
 constexpr int LOAD_SAVE_MSG_INDEX = 4;
 constexpr int ERROR_MSG_INDEX = 8;
+constexpr int HINT_MSG_INDEX = 9;
 constexpr const char* MESSAGES[] = {
     "", // No message
     "Congratulations! You won!", // Yellow
@@ -21,6 +25,7 @@ constexpr const char* MESSAGES[] = {
     "Game Saved", // Green
     "Game Loaded", // Green
     "Invalid move", // Red
+    "Hint: ", // Cyan
     // Add more invalid moves in the future if needed, so index will not fuck up
 };
 
@@ -35,20 +40,29 @@ public:
 
     Cursor* getCursor();
     Info* getInfo();
+    SlotBrowser* getSlotBrowser();
+    ReplayViewer* getReplayViewer();
 
     void setMessage(int);
     bool resetMessage(bool);
+    void setHint(const string&);
+    void clearHint();
 
 private:
     int currentMessageIndex;
+    // Rows the game takes up, taller in thoughtful mode
+    int height;
+    string hintText;
 
     Cursor* cursor = nullptr;
     Game* game = nullptr;
     Info* info = nullptr;
+    SlotBrowser* slotBrowser = nullptr;
+    ReplayViewer* replayViewer = nullptr;
 
     void drawBoundary();
     void drawMenu(bool);
-    void drawGameBoard();
+    void drawGameBoard(bool);
 
     // Secondary drawing functions
     void drawVerticalDelimiter(int);
@@ -57,7 +71,7 @@ private:
     void drawFoundation(Suit);
     void drawMessage(bool);
 
-    int drawCard(int, int, int, int, Card*[]);
+    int drawCard(int, int, int, Card* const[], int, Card* const[]);
     void drawCardDivider(int, int, bool);
 
     string getSuitChar(Suit);
@@ -2,24 +2,37 @@
 
 #include <random>
 #include <ctime>
+#include <chrono>
 
 #include "common.hpp"
 #include "persistence.hpp"
+#include "boardview.hpp"
+#include "history.hpp"
+#include "archive.hpp"
+#include "rules.hpp"
 
 // Forward declarations
 
 class Display;
 class Board;
 class Logic;
+class Autosave;
+class SaveWorker;
+class SaveStore;
+class AnalysisWorker;
 
 class Game
 {
 public:
-    Game();
+    Game(bool);
     ~Game();
 
     void createGame(bool);
     void finishGame();
+    void enableAutosave();
+    void enableArchive();
+    void setRuleVariant(RuleVariant);
+    void startReplayViewer(uint32_t, RuleVariant, const Move*, int);
 
     void update();
 
@@ -32,30 +45,50 @@ public:
 
     Display* getDisplay();
     Board* getBoard();
+    const BoardView* getBoardView();
+    SaveStore* getSaveStore();
     
     void setIsRunning(bool);
 
 private:
     bool isRunning;
-    bool isGamePreviouslyCreated;
     bool hasAlreadyWon;
     bool hasAlreadyPromptedAutoFinished;
     GameState gameState;
     MenuOption menuOption;
 
-    Card* deck[MAX_CARDS] = { nullptr };
+    // Only picks the seed of each deal, the deal itself is shuffled by the board
+    std::mt19937 seedGenerator;
     
     Board* board = nullptr;
+    MoveHistory* history = nullptr;
+    BoardView boardView;
     Logic* logic = nullptr;
     Display* display = nullptr;
     Persistence* persistence = nullptr;
+    Autosave* autosave = nullptr;
+    SaveWorker* saveWorker = nullptr;
+    SaveStore* saveStore = nullptr;
+    ArchiveWriter* archive = nullptr;
+    AnalysisWorker* analysisWorker = nullptr;
+    RuleVariant ruleVariant;
 
-    void cleanUp(bool);
+    // Moves of the position last sent for analysis, -1 once a new game starts
+    int analysedMoves;
+    // A hint was asked for before its analysis was done
+    bool isHintPending;
 
-    void createCards();
-    void deleteCards();
-    void shuffleCards();
+    // Whether the current game is already in the archive
+    bool hasArchivedGame;
+    std::chrono::steady_clock::time_point startTime;
+
+    void cleanUp();
 
     void handleArrowKeys(ArrowKey);
+    void handleReplayKey(int);
+    void handleHintKey();
+    void showHint();
     void handleEnterKey();
+    void handleSlotSelection();
+    void archiveGame(GameResult);
 };
\ No newline at end of file
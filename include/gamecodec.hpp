@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+
+#include "common.hpp"
+#include "move.hpp"
+#include "replay.hpp"
+
+// Positions with more legal moves than this share the last context
+constexpr int CODEC_CONTEXT_COUNT = 32;
+constexpr int CODEC_FREQUENCY_STEP = 24;
+// Must stay below the coder's 16 bit bottom value
+constexpr int CODEC_MAX_TOTAL = 1 << 15;
+// Longer games are not coded, and a larger count in a record means it is corrupt
+constexpr uint32_t CODEC_MAX_MOVE_COUNT = UINT16_MAX;
+
+/*
+Compact game records: every move is stored as its index among the legal moves of its position,
+in the order Logic::generateMoves produces them, so the deal (seed and rule variant) must be known to decode
+
+Format: Move Count (varint) | Range coded move indices
+The indices are coded with adaptive frequencies, one model per number of legal moves.
+Drawing is always generated last, so indices are rotated by one to make it symbol 0
+A position with a single legal move costs nothing
+*/
+class GameCodec
+{
+public:
+    GameCodec();
+
+    bool encode(uint32_t, RuleVariant, const Move*, int, vector<char>*);
+    bool decode(uint32_t, RuleVariant, const char*, int, vector<Move>*);
+
+    // Position after the last encode or decode
+    const Board* getBoard();
+    bool isGameWon();
+
+private:
+    Replay replay;
+    uint16_t frequencies[CODEC_CONTEXT_COUNT][MAX_MOVES];
+    int totals[CODEC_CONTEXT_COUNT];
+
+    void resetModel();
+    int getContext(int);
+    int getCumulativeFrequency(int, int);
+    int getTotalFrequency(int, int);
+    void updateModel(int, int);
+};
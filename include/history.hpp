@@ -0,0 +1,37 @@
+#pragma once
+
+#include "common.hpp"
+#include "move.hpp"
+
+/*
+Every move made since the deal, in order
+
+Compact encoding, 1 to 2 bytes per move
+Byte 1: From pile (high 4 bits), To pile (low 4 bits)
+Byte 2: Card count, only for stack to stack moves
+*/
+class MoveHistory
+{
+public:
+    MoveHistory();
+
+    void clear();
+    void addMove(const Move&);
+    void truncate(int);
+
+    int getLength() const;
+    Move getMove(int) const;
+
+    int getEncodedLength() const;
+    void encode(char*) const;
+    bool decode(const char*, int);
+
+    static int getEncodedMoveLength(const Move&);
+    static int encodeMove(const Move&, char*);
+    // Returns the number of bytes read, 0 if the bytes are not a valid move
+    static int decodeMove(const char*, int, Move*);
+
+private:
+    int encodedLength;
+    vector<Move> moves;
+};
@@ -18,7 +18,9 @@ const string CONTROLS[] = {
     "Controls",
     "- Arrow Keys to move the cursor or change pagination",
     "- Enter key to lock the cursor or make a move",
-    "- Backspace/Delete key to toggle Menu or dismiss errors"
+    "- Backspace/Delete key to toggle Menu or dismiss errors",
+    "- H key to show a hint for the next move",
+    "- Replays: Left/Right to step, Up/Down or Home/End to seek, +/- to change speed, Enter to play or pause"
 };
 const string ABOUT[] = {
     "About",
@@ -26,7 +28,7 @@ const string ABOUT[] = {
     "v1.0.0 - May 21,2024",
     "Created for COMP2113/ENGG1340 Freeriders",
 };
-constexpr int SECTION_LENGTH[3] = { 8, 4, 4 };
+constexpr int SECTION_LENGTH[3] = { 8, 6, 4 };
 
 class Info
 {
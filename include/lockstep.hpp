@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+
+#include "common.hpp"
+#include "move.hpp"
+
+class Board;
+
+// Games of a block, every per game array of a block is this long so the checks compile to fixed length vector loops
+constexpr int LOCKSTEP_LANES = 64;
+// Moves a game may make before it is called lost
+constexpr int LOCKSTEP_MAX_MOVES = 400;
+
+/*
+Moves a playout picks from, in order of priority
+Every foundation move, then moves that turn a face down card or place the waste card, then draws
+Runs are only moved whole and only off face down cards, so nothing is shuffled back and forth
+*/
+enum LockstepPriority
+{
+    NO_MOVE,
+    DRAW_PRIORITY,
+    BUILD_PRIORITY,
+    FOUNDATION_PRIORITY
+};
+
+/*
+Move numbers within a game's move code
+0-6: Stack to foundation, 7: Waste to foundation, 8-14: Waste to stack,
+15-63: Run from stack s to stack t (15 + 7s + t), 64: Draw
+*/
+constexpr int LOCKSTEP_WASTE_TO_FOUNDATION = STACK_COUNT;
+constexpr int LOCKSTEP_FIRST_WASTE_TO_STACK = LOCKSTEP_WASTE_TO_FOUNDATION + 1;
+constexpr int LOCKSTEP_FIRST_RUN = LOCKSTEP_FIRST_WASTE_TO_STACK + STACK_COUNT;
+constexpr int LOCKSTEP_DRAW = LOCKSTEP_FIRST_RUN + STACK_COUNT * STACK_COUNT;
+
+// The playout policy, shared by the simulator and anything that plays the same playouts through Board
+constexpr LockstepPriority getLockstepPriority(int moveNumber)
+{
+    return moveNumber == LOCKSTEP_DRAW ? DRAW_PRIORITY : moveNumber <= LOCKSTEP_WASTE_TO_FOUNDATION ? FOUNDATION_PRIORITY : BUILD_PRIORITY;
+}
+
+// Move number of a move in the format of Logic, -1 for moves a playout never makes
+int getLockstepMoveNumber(const Board&, const Move&);
+
+/*
+A block of games in structure of arrays layout, [pile][game] so one pile of every game is contiguous
+Pile tops and the first face up card of each stack are kept as values, suits and colors, next to the cards themselves
+The stock and the waste are one row of cards in deal order, the waste first
+*/
+struct LockstepBlock
+{
+    uint8_t stackCards[STACK_COUNT][MAX_STACK_LENGTH][LOCKSTEP_LANES];
+    uint8_t stackLengths[STACK_COUNT][LOCKSTEP_LANES];
+    uint8_t hiddenCounts[STACK_COUNT][LOCKSTEP_LANES];
+
+    // 0 for an empty stack
+    uint8_t topValues[STACK_COUNT][LOCKSTEP_LANES];
+    uint8_t topSuits[STACK_COUNT][LOCKSTEP_LANES];
+    uint8_t topColors[STACK_COUNT][LOCKSTEP_LANES];
+    uint8_t baseValues[STACK_COUNT][LOCKSTEP_LANES];
+    uint8_t baseColors[STACK_COUNT][LOCKSTEP_LANES];
+
+    uint8_t foundationLengths[FOUNDATION_COUNT][LOCKSTEP_LANES];
+
+    uint8_t unusedCards[RESERVED_CARDS][LOCKSTEP_LANES];
+    uint8_t unusedLengths[LOCKSTEP_LANES];
+    uint8_t wasteLengths[LOCKSTEP_LANES];
+    // 0 for an empty waste
+    uint8_t wasteValues[LOCKSTEP_LANES];
+    uint8_t wasteSuits[LOCKSTEP_LANES];
+    uint8_t wasteColors[LOCKSTEP_LANES];
+
+    // Draws since the last other move, a game that goes twice through the stock without another move is stuck
+    uint8_t drawStreaks[LOCKSTEP_LANES];
+    // 0xFF while the game is still being played
+    uint8_t playingMasks[LOCKSTEP_LANES];
+    uint16_t moveCounts[LOCKSTEP_LANES];
+    uint32_t randomStates[LOCKSTEP_LANES];
+
+    // Priority, 5 random bits and the move number of the best move of each game
+    uint16_t moveCodes[LOCKSTEP_LANES];
+};
+
+/*
+Random playouts of thousands of games at once, every game makes one move per step
+Finding the legal moves of every game is branch free over whole blocks, so the compiler turns it into vector code
+Only applying the chosen move touches one game at a time
+Rules are Klondike with unlimited redeals, drawing one or three cards
+*/
+class LockstepSimulator
+{
+public:
+    LockstepSimulator(int);
+
+    void deal(const uint32_t*, int);
+    // Plays every game to the end, returns the number of steps
+    int run();
+
+    int getGameCount();
+    bool getIsWon(int);
+    int getMoveCount(int);
+    // Every move made by every game, in the move format of Logic, empty unless recording
+    void setIsRecording(bool);
+    const vector<Move>& getMoves(int);
+
+private:
+    int drawCount;
+    int gameCount;
+    vector<LockstepBlock> blocks;
+    bool isRecording;
+    vector<vector<Move>> moves;
+
+    bool step(LockstepBlock*);
+    void findMoves(LockstepBlock*);
+    void applyMove(LockstepBlock*, int, int, int);
+    void updateStack(LockstepBlock*, int, int);
+    void updateWaste(LockstepBlock*, int);
+};
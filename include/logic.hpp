@@ -1,8 +1,13 @@
 #pragma once
 
 #include "common.hpp"
+#include "cardmask.hpp"
+#include "bitboard.hpp"
+#include "history.hpp"
+#include "rules.hpp"
 
 #include "board.hpp"
+#include "boardview.hpp"
 #include "display.hpp"
 
 class Board;
@@ -11,29 +16,28 @@ class Display;
 class Logic
 {
 public:
-    Logic(Board*, Display*);
+    Logic(Board*, Display*, const BoardView*, MoveHistory*);
     ~Logic();
 
     bool isGameWon();
     bool canAutoFinish();
+    bool autoFinish();
+    int generateMoves(Move*);
 
     void handleUnusedCardSelection(int);
     bool handleStackSelection(int, int, int);
     bool handleFoundationSelection(int, int);
 
+    // The rules are those of the board, which a save restores along with the position
+    bool applyMove(const Move&);
+
 private:
     Board* board = nullptr;
     Display* display = nullptr;
+    const BoardView* view = nullptr;
+    MoveHistory* history = nullptr;
+    Bitboard bitboard;
 
-    bool stackToStack(int, int, int);
-    bool stackToFoundation(int);
-    bool unusedToStack(int);
-    bool unusedToFoundation();
-    bool foundationToStack(int, int);
-
-    static bool canExistingStackAcceptCard(Card*, Card*);
-    static bool canEmptyStackAcceptCard(Card*);
-
-    static bool canEmptyFoundationAcceptCard(Card*);
-    static bool canExistingFoundationAcceptCard(Card*, Card*);
+    bool finishSelection(bool);
+    void recordMove(const Move&);
 };
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+
+#include "common.hpp"
+
+// Piles as seen by a move: the unused pile, then the stacks, then the foundations ordered by suit
+constexpr int UNUSED_PILE = 0;
+constexpr int FIRST_STACK_PILE = 1;
+constexpr int FIRST_FOUNDATION_PILE = FIRST_STACK_PILE + STACK_COUNT;
+constexpr int PILE_COUNT = FIRST_FOUNDATION_PILE + FOUNDATION_COUNT;
+
+// Upper bound of legal moves in any position
+constexpr int MAX_MOVES = 256;
+
+/*
+Draw/Recycle: UNUSED_PILE to UNUSED_PILE
+Unused pile to stack or foundation, stack to foundation, foundation to stack: count is 1
+Stack to stack: count is the number of cards taken from the top of the stack
+*/
+struct Move
+{
+    uint8_t from;
+    uint8_t to;
+    uint8_t count;
+};
+
+inline bool operator==(const Move& a, const Move& b)
+{
+    return a.from == b.from && a.to == b.to && a.count == b.count;
+}
+
+inline bool isStackPile(int pile)
+{
+    return pile >= FIRST_STACK_PILE && pile < FIRST_FOUNDATION_PILE;
+}
+
+inline bool isFoundationPile(int pile)
+{
+    return pile >= FIRST_FOUNDATION_PILE && pile < PILE_COUNT;
+}
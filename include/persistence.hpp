@@ -1,41 +1,80 @@
 #pragma once
 
+#include <cstdio>
+
 #include "common.hpp"
 #include "board.hpp"
+#include "history.hpp"
 
 #define SEP_COUNT 9
 
 constexpr char SAVEFILE_NAME[] = "save.sol";
 
+constexpr int SAVEFILE_MAGIC_LENGTH = 4;
+constexpr int SAVEFILE_VERSION = 3;
+// Magic, version, rule variant, redeal count and CRC32
+constexpr int SAVEFILE_HEADER_LENGTH = SAVEFILE_MAGIC_LENGTH + 1 + 1 + 1 + 4;
+// Magic, version, draw count and CRC32
+constexpr int V2_HEADER_LENGTH = SAVEFILE_MAGIC_LENGTH + 1 + 1 + 4;
+constexpr int V1_MIN_LENGTH = 16;
+constexpr int V1_MAX_LENGTH = 64;
+constexpr int MAX_SAVEFILE_LENGTH = 1 << 20;
+
+// Copy of everything a save needs, so the save can be written while the game goes on
+struct SaveSnapshot
+{
+    Board board;
+    MoveHistory history;
+};
+
 class Persistence
 {
 public:
-    Persistence(Board* board, Card** deck);
+    Persistence(Board* board, MoveHistory* history);
     ~Persistence();
 
     bool saveFile();
     bool loadFile();
+    bool saveFile(const char*);
+    bool loadFile(const char*);
+    uint32_t getLastChecksum();
+
+    void takeSnapshot(SaveSnapshot*);
+    static bool writeFile(const char*, const SaveSnapshot&, uint32_t*);
+    static int writeRecord(const Board&, char*);
+    static bool readRecord(Board*, const char*, int);
+    static void writeCardData(const Card*, bool, char*, int*);
     void saveDebugInfo(string);
 
+    static uint32_t getChecksum(const char*, int);
+    static bool syncFile(FILE*);
+    static bool replaceFile(const char*, const char*);
+
 private:
     Board* board = nullptr;
-    Card** deck = nullptr;
+    MoveHistory* history = nullptr;
+    uint32_t checksum;
+    SaveSnapshot snapshot;
+
+    static int getArrayLength(const Board&);
 
-    int getArrayLength();
+    static void writeSaveData(const Board&, char*);
+    bool readVersionedData(const char*, int);
+    static bool readSaveData(Board*, const char*, int);
 
-    char* writeSaveData(int);
-    bool readSaveData(char*, int);
+    static void writeStackData(const Board&, int, char*, int*);
+    static void writeFoundationData(const Board&, int, char*, int*);
+    static void writeUnusedData(const Board&, char*, int*);
+    static void writeSep(char*, int*);
 
-    void writeStackData(int, char*, int*);
-    void writeFoundationData(int, char*, int*);
-    void writeUnusedData(char*, int*);
-    void writeSep(char*, int*);
-    void writeCardData(Card*, char*, int*);
+    static bool readStackData(Board*, const char*, int, int, int);
+    static bool readFoundationData(Board*, const char*, int, int);
+    static bool readUnusedData(Board*, const char*, int, int);
+    static bool readMovesData(Board*, const char*, int);
+    static Card* readCardData(char, bool*);
 
-    bool readStackData(char*, int, int, int);
-    bool readFoundationData(char*, int, int);
-    bool readUnusedData(char*, int, int);
-    bool readMovesData(char*, int);
-    Card* readCardData(char);
+    static bool hasMagic(const char*, int);
+    static void writeUint32(uint32_t, char*, int*);
+    static uint32_t readUint32(const char*, int*);
 
 };
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "common.hpp"
+#include "move.hpp"
+#include "board.hpp"
+#include "logic.hpp"
+
+/*
+Text notation of a move, one token per move
+s: Draw from the stock (or recycle the waste)
+w3, wH: Waste to stack 3, Waste to the Hearts foundation
+3H, 35: Stack 3 to the Hearts foundation, Top card of stack 3 to stack 5
+35x3: Top 3 cards of stack 3 to stack 5
+H3: Hearts foundation to stack 3
+*/
+constexpr char FOUNDATION_NOTATION[FOUNDATION_COUNT + 1] = "DCHS";
+
+bool parseMove(const string&, Move*);
+string formatMove(const Move&);
+// A move in words, for players rather than programs
+string describeMove(const Move&);
+
+/*
+Text of a position, one line of space separated fields
+Moves, Stock length, Waste top, Foundation lengths (D C H S), then the 7 stacks bottom to top
+Cards are a value and a suit (AS, TD, KH), ## is a face down card and - an empty waste or stack
+*/
+string formatCard(const Card*);
+string formatBoard(const Board&);
+
+struct ReplayResult
+{
+    // Index of the first illegal move, -1 if every move was legal
+    int illegalMoveIndex;
+    int appliedMoveCount;
+    bool isWon;
+};
+
+// Replays a deal and its moves through the game rules, without a display
+class Replay
+{
+public:
+    Replay();
+
+    ReplayResult run(uint32_t, RuleVariant, const Move*, int);
+    ReplayResult runEncoded(uint32_t, RuleVariant, const char*, int);
+
+    // Step by step, for callers that walk the game themselves
+    void deal(uint32_t, RuleVariant);
+    int generateMoves(Move*);
+    bool applyMove(const Move&);
+    bool isGameWon();
+
+    const Board* getBoard();
+
+private:
+    Board board;
+    Logic logic;
+
+    ReplayResult getResult(int, int);
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <chrono>
+
+#include "common.hpp"
+#include "timeline.hpp"
+
+constexpr int REPLAY_SPEED_COUNT = 6;
+constexpr int REPLAY_STEP_DELAYS_MS[REPLAY_SPEED_COUNT] = { 1000, 500, 250, 100, 50, 20 };
+constexpr int REPLAY_DEFAULT_SPEED = 2;
+// Up and Down jump by this fraction of the game, but at least one keyframe interval
+constexpr int REPLAY_SEEK_DIVISOR = 10;
+
+// Watches a game move by move, on top of a keyframed timeline so any move is a cheap seek away
+class ReplayViewer
+{
+public:
+    ReplayViewer();
+
+    int load(uint32_t, RuleVariant, const Move*, int);
+
+    void step(bool);
+    void seekPage(bool);
+    void seekEnd(bool);
+    void togglePlaying();
+    void shiftSpeed(bool);
+
+    void update();
+    void render(int);
+
+    // Milliseconds until the next move is played, -1 if paused
+    int getStepDelay();
+    Board* getBoard();
+
+private:
+    Timeline timeline;
+    bool isPlaying;
+    int speedIndex;
+    std::chrono::steady_clock::time_point nextStepTime;
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "common.hpp"
+#include "cardmask.hpp"
+#include "move.hpp"
+#include "board.hpp"
+#include "bitboard.hpp"
+
+constexpr int UNLIMITED_REDEALS = -1;
+
+/*
+Rule policies of the Klondike variants, every rule is a compile time constant
+DRAW_COUNT: Cards turned from the stock at a time
+REDEAL_LIMIT: How often the waste may be turned back into the stock
+EMPTY_STACK_CARDS: Cards an empty stack accepts
+CAN_MOVE_FROM_FOUNDATION: Whether foundation cards may go back onto the stacks
+*/
+struct StandardRules
+{
+    static constexpr int DRAW_COUNT = 1;
+    static constexpr int REDEAL_LIMIT = UNLIMITED_REDEALS;
+    static constexpr CardMask EMPTY_STACK_CARDS = KING_CARDS;
+    static constexpr bool CAN_MOVE_FROM_FOUNDATION = true;
+};
+
+struct DrawThreeRules : StandardRules
+{
+    static constexpr int DRAW_COUNT = 3;
+};
+
+// A single pass through the stock, and cards on the foundations stay there
+struct VegasRules : StandardRules
+{
+    static constexpr int REDEAL_LIMIT = 0;
+    static constexpr bool CAN_MOVE_FROM_FOUNDATION = false;
+};
+
+// Three passes through the stock
+struct VegasDrawThreeRules : VegasRules
+{
+    static constexpr int DRAW_COUNT = 3;
+    static constexpr int REDEAL_LIMIT = 2;
+};
+
+template <class Rules>
+inline bool canRedeal(int redealCount)
+{
+    return Rules::REDEAL_LIMIT == UNLIMITED_REDEALS || redealCount < Rules::REDEAL_LIMIT;
+}
+
+/*
+The move validator and generator of one variant, both compiled for its rules
+The variant is picked once per game, so the rules are never checked at runtime
+*/
+struct RuleSet
+{
+    int drawCount;
+    // Applies a move if it is legal, without recording it
+    bool (*applyMove)(Board*, const Move&);
+    // The bitboard is scratch space, so generating moves does not allocate
+    int (*generateMoves)(Board*, Bitboard*, Move*);
+};
+
+const RuleSet* getRuleSet(RuleVariant);
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+
+#include "common.hpp"
+#include "board.hpp"
+#include "persistence.hpp"
+
+constexpr char SAVESTORE_NAME[] = "saves.sol";
+constexpr int SAVESTORE_VERSION = 2;
+constexpr int SAVE_SLOT_COUNT = 4096;
+// A record is the v1 save body, which never exceeds 64 bytes
+constexpr int SAVE_RECORD_LENGTH = V1_MAX_LENGTH;
+
+struct SaveStoreHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t recordLength;
+    char reserved[48];
+};
+
+// What a slot holds, readable without parsing its record. A timestamp of 0 marks an empty slot
+struct SaveSlotInfo
+{
+    int64_t timestamp;
+    uint32_t seed;
+    uint16_t moves;
+    uint8_t recordLength;
+    uint8_t ruleVariant;
+    // Capped at 255 like in a save file
+    uint8_t redealCount;
+    char reserved[7];
+};
+
+static_assert(sizeof(SaveStoreHeader) == 64, "The header fills one record");
+static_assert(sizeof(SaveSlotInfo) == 24, "Slot infos are packed without padding");
+
+/*
+Every save slot in a single memory mapped file
+Header[64] | Slot Infos[24 * SAVE_SLOT_COUNT] | Records[64 * SAVE_SLOT_COUNT]
+
+Once mapped, listing, loading and saving a slot only touches memory, the OS writes the pages back
+Numbers are in host byte order, as the file is only meant for the machine it was written on
+Windows has no mmap, so the file is read into memory once and each save writes its slot back
+*/
+class SaveStore
+{
+public:
+    SaveStore();
+    ~SaveStore();
+
+    bool open(bool);
+    bool getIsOpen();
+
+    const SaveSlotInfo* getSlotInfo(int);
+    bool saveSlot(int, const Board&);
+    bool loadSlot(int, Board*);
+
+private:
+    char* data = nullptr;
+    SaveSlotInfo* slotInfos = nullptr;
+    char* records = nullptr;
+#ifdef _WIN32
+    vector<char> buffer;
+#else
+    int fileDescriptor;
+#endif
+
+    void close();
+    bool syncSlot(int);
+};
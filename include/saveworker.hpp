@@ -0,0 +1,55 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "common.hpp"
+#include "persistence.hpp"
+
+// How often the input loop checks for a finished save
+constexpr int SAVE_POLL_INTERVAL_MS = 50;
+
+// Runs on the worker thread once a save is in place, with the save's checksum, the save fails if it does
+typedef bool (*SavedHook)(uint32_t);
+
+/*
+Writes saves on a background thread, so a slow disk never stalls input
+The game state is copied into a snapshot on the input thread, then written to a temp file
+that is renamed over the save file. A save requested while one is being written replaces
+any save still waiting, only the latest state matters
+*/
+class SaveWorker
+{
+public:
+    SaveWorker(Persistence*);
+    ~SaveWorker();
+
+    void requestSave(const char*, SavedHook);
+    bool pollResult(bool*);
+    bool getIsBusy();
+    void wait();
+
+private:
+    Persistence* persistence = nullptr;
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::condition_variable idleCondition;
+
+    // Guarded by the mutex
+    SaveSnapshot pendingSnapshot;
+    const char* pendingFileName = nullptr;
+    SavedHook pendingHook = nullptr;
+    bool hasPendingSave;
+    bool isWriting;
+    bool hasResult;
+    bool isSaved;
+    bool isStopping;
+
+    // Only used by the worker thread
+    SaveSnapshot writingSnapshot;
+
+    void run();
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+
+#include "common.hpp"
+#include "rules.hpp"
+#include "session.hpp"
+
+constexpr char SERVER_SOCKET_NAME[] = "solitaire.sock";
+// A command line longer than this closes the connection
+constexpr int SERVER_MAX_LINE_LENGTH = 4096;
+constexpr int SERVER_READ_LENGTH = 65536;
+constexpr int SERVER_MAX_EVENTS = 256;
+
+/*
+Many games in one process, played over a Unix domain socket
+Each line is one command, and each command gets exactly one response line, in order
+open: Start a session, answers "ok <session>"
+close <session>: End a session
+<session> <command> [args]: A GameSession command (deal, play, moves, state)
+
+Sessions belong to the connection that opened them and end with it
+Each connection is handed to one worker, which owns its sessions and runs its own epoll loop,
+so a session is only ever touched by one thread and needs no locking
+Commands are answered as they are read, all responses to one read are sent together
+*/
+struct ServerConnection
+{
+    int fileDescriptor;
+    string input;
+    string output;
+    size_t outputOffset;
+    // Only EPOLLOUT is watched until the output is sent
+    bool isWaitingForOutput;
+    // Indexed by session, nullptr once closed
+    vector<GameSession*> sessions;
+    vector<int> freeSessions;
+};
+
+class ServerWorker
+{
+public:
+    ServerWorker(RuleVariant);
+    ~ServerWorker();
+
+    bool start();
+    void stop();
+    void addConnection(int);
+
+private:
+    SessionPool sessionPool;
+    int epollDescriptor;
+    // Wakes the worker for new connections and for stopping
+    int eventDescriptor;
+    std::thread thread;
+
+    // Guarded by the mutex
+    std::mutex mutex;
+    vector<int> pendingConnections;
+    bool isStopping;
+
+    void run();
+    void acceptPendingConnections();
+    bool readConnection(ServerConnection*);
+    bool flushConnection(ServerConnection*);
+    void closeConnection(ServerConnection*);
+    void handleLine(ServerConnection*, const string&);
+};
+
+class GameServer
+{
+public:
+    GameServer(RuleVariant, int);
+    ~GameServer();
+
+    // Serves until SIGINT or SIGTERM, returns the exit code
+    int run(const char*);
+
+private:
+    vector<ServerWorker*> workers;
+};
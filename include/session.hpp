@@ -0,0 +1,78 @@
+#pragma once
+
+#include "common.hpp"
+#include "move.hpp"
+#include "board.hpp"
+#include "history.hpp"
+#include "logic.hpp"
+#include "rules.hpp"
+#include "persistence.hpp"
+
+// Undo never replays more than this many moves
+constexpr int SESSION_KEYFRAME_INTERVAL = 16;
+
+/*
+A game without a display, driven by text commands
+deal <seed>: Deal a new game
+play <move>: Make a move in move notation (see replay.hpp)
+moves: List the legal moves
+state: Print the position (see formatBoard)
+undo: Take back the last move
+
+Every command answers with one line, "ok ..." or "err <reason>"
+*/
+class GameSession
+{
+public:
+    GameSession(RuleVariant);
+
+    void deal(uint32_t);
+    bool applyMove(const Move&);
+    bool undo();
+    int generateMoves(Move*);
+    bool isGameWon();
+    const Board* getBoard();
+
+    // Returns false if the command is unknown, the response has no line break
+    bool handleCommand(const string&, std::istream&, string*);
+
+private:
+    Board board;
+    MoveHistory history;
+    Logic logic;
+
+    // Every SESSION_KEYFRAME_INTERVAL moves the position is kept as a v1 save record and its redeal count, like a Timeline
+    vector<char> keyframes;
+    vector<uint8_t> keyframeLengths;
+    vector<int> keyframeRedealCounts;
+    // Moves replayed on top of a keyframe, kept so an undo does not allocate
+    vector<Move> undoMoves;
+
+    void addKeyframe();
+};
+
+// Sessions are allocated this many at a time, in one block
+constexpr int SESSION_SLAB_LENGTH = 256;
+
+/*
+Fixed size session records, carved from slabs and kept on a free list
+A released session is not destroyed, so acquiring one is a free list pop and a new deal,
+and its move history keeps the capacity it grew to. Sessions of one slab sit next to each other in memory
+Not thread safe, each server worker has its own pool
+*/
+class SessionPool
+{
+public:
+    SessionPool(RuleVariant);
+    ~SessionPool();
+
+    GameSession* acquire();
+    void release(GameSession*);
+
+private:
+    RuleVariant ruleVariant;
+    vector<GameSession*> slabs;
+    // Sessions constructed in the last slab
+    int slabLength;
+    vector<GameSession*> freeSessions;
+};
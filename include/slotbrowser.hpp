@@ -0,0 +1,32 @@
+#pragma once
+
+#include "common.hpp"
+#include "savestore.hpp"
+
+// Row 0 is the classic save file, rows 1 and up are the slots of the save store
+constexpr int SLOT_BROWSER_ROW_COUNT = 1 + SAVE_SLOT_COUNT;
+constexpr int SLOT_BROWSER_VISIBLE_ROWS = HEIGHT - 7;
+
+class SlotBrowser
+{
+public:
+    SlotBrowser(SaveStore*);
+
+    void shiftRow(bool);
+    void shiftPage(bool);
+    void render();
+
+    int getSelectedRow();
+    GameState getPrevMenuState();
+    void setPrevMenuState(GameState);
+
+private:
+    SaveStore* store = nullptr;
+    GameState prevMenuState;
+
+    int topRowIndex;
+    int selectedRowIndex;
+
+    void clampTopRow();
+    string getRowText(int);
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+
+#include "common.hpp"
+#include "move.hpp"
+#include "board.hpp"
+#include "rules.hpp"
+
+// Positions searched before the solver gives up, enough for positions about 30 moves from a win
+constexpr uint64_t ENDGAME_NODE_BUDGET = 10000000;
+// Longer solutions are not looked for
+constexpr int ENDGAME_MAX_MOVES = 250;
+// The transposition table has 1 << ENDGAME_TABLE_BITS entries, 16 bytes each
+constexpr int ENDGAME_TABLE_BITS = 22;
+
+/*
+At least as many moves as any win from the position still needs, so the first win iterative deepening finds is a shortest one
+Cards on the foundations do not count down one move each, since a chain of stack cards goes up in 1 move:
+Every card on a stack needs a move that takes it off, and a face down card cannot go in the same move as the cards above it
+Every stock and waste card leaves the waste in a move of its own, and the stock takes a draw per draw count cards
+*/
+int getMoveLowerBound(const Board&, int);
+
+struct EndgameResult
+{
+    // A shortest win was found
+    bool isWon;
+    // Every position was searched without a win
+    bool hasNoWin;
+    // Moves of the shortest win, otherwise the moves every win needs at least, counted from the position solved
+    int moveCount;
+    vector<Move> moves;
+    uint64_t nodeCount;
+};
+
+enum EndgameSearchResult
+{
+    ENDGAME_NOT_WON,
+    ENDGAME_WON,
+    ENDGAME_OUT_OF_BUDGET
+};
+
+/*
+Shortest win of an endgame by IDA*, depth first searches with a bound on the moves made plus the lower bound left
+The lower bound is far below the moves a whole deal needs, so from the deal the search runs out of budget
+and only proves that many moves; close to a win it is tight enough to solve the position exactly
+The bound grows to the smallest total that went over it, until a search wins
+The transposition table keeps the moves left to the bound each position was searched with, by its canonical hash
+A position already searched with at least as many moves left is skipped, in this search or any later one
+The table may forget positions, which only costs time
+Of two moves in a row on separate piles only one order is searched, the other reaches the same position
+*/
+class EndgameSolver
+{
+public:
+    EndgameSolver(RuleVariant);
+
+    EndgameResult solve(const Board&, uint64_t);
+
+private:
+    struct TableEntry
+    {
+        uint64_t hash;
+        int remainingMoves;
+    };
+
+    const RuleSet* rules = nullptr;
+    vector<Board> boards;
+    vector<Move> path;
+    vector<TableEntry> table;
+    uint64_t nodeCount;
+    uint64_t nodeBudget;
+
+    EndgameSearchResult search(int, int, int*);
+    bool checkTable(uint64_t, int, int, int*);
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+
+#include "common.hpp"
+#include "move.hpp"
+#include "board.hpp"
+#include "logic.hpp"
+#include "persistence.hpp"
+
+// Seeking never replays more than this many moves
+constexpr int KEYFRAME_INTERVAL = 32;
+
+/*
+A game that can be positioned at any of its moves
+Every KEYFRAME_INTERVAL moves the position is kept as a v1 save record (16 to 64 bytes) and its redeal count,
+so a seek loads the nearest keyframe before the target and replays the rest
+*/
+class Timeline
+{
+public:
+    Timeline();
+
+    int load(uint32_t, RuleVariant, const Move*, int);
+    void seek(int);
+
+    int getPosition();
+    int getLength();
+    const Move& getMove(int);
+    Board* getBoard();
+
+private:
+    Board board;
+    Logic logic;
+
+    uint32_t seed;
+    vector<Move> moves;
+    int position;
+
+    vector<char> keyframes;
+    vector<uint8_t> keyframeLengths;
+    // A v1 record has no redeal count, the Vegas variants need it to replay the moves after the keyframe
+    vector<int> keyframeRedealCounts;
+
+    void addKeyframe();
+    void loadKeyframe(int);
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <unordered_set>
+
+#include "common.hpp"
+#include "move.hpp"
+#include "board.hpp"
+#include "rules.hpp"
+#include "analysis.hpp"
+
+// A game that has not been won by then counts as lost
+constexpr int TOURNAMENT_MAX_MOVES = 500;
+// A game gives up once the best scored position has not improved for this many moves
+constexpr int TOURNAMENT_STALL_MOVES = 60;
+// Deals a thread takes at a time
+constexpr int TOURNAMENT_DEAL_BATCH = 64;
+constexpr int ROLLOUT_COUNT = 2;
+constexpr int ROLLOUT_LENGTH = 12;
+// Positions searched after each candidate move
+constexpr int SEARCH_NODE_BUDGET = 200;
+
+/*
+Greedy: The move to the best scored position
+Rollout: The move with the best average score after a few random games from it
+Search: The move with the best line MoveSearch finds within a small budget
+*/
+enum Strategy
+{
+    GREEDY_STRATEGY,
+    ROLLOUT_STRATEGY,
+    SEARCH_STRATEGY,
+    STRATEGY_COUNT
+};
+
+constexpr const char* STRATEGY_NAMES[STRATEGY_COUNT] = { "Greedy", "Rollout", "Search" };
+
+struct DealResult
+{
+    bool isWon;
+    uint16_t moveCount;
+    // Thread CPU time of the game
+    uint32_t microseconds;
+};
+
+// Plays deals with any strategy, one player per thread
+class TournamentPlayer
+{
+public:
+    TournamentPlayer(RuleVariant);
+
+    DealResult play(Strategy, uint32_t);
+
+private:
+    const RuleSet* rules = nullptr;
+    Board board;
+    Board nextBoards[MAX_MOVES];
+    Move moves[MAX_MOVES];
+    // Canonical positions of this game, a move back to one of them is never made, so no strategy loops forever
+    // Swapping two stacks does not count as a new position either
+    std::unordered_set<uint64_t> seenPositions;
+    std::mt19937 rng;
+    MoveSearch search;
+
+    int chooseMove(Strategy, const int*, int);
+    int scoreRollout(const Board&);
+};
+
+/*
+Every strategy plays the same numbered deals, spread over a pool of threads
+Results are kept per deal, so strategies can be compared deal by deal as well as overall
+*/
+class Tournament
+{
+public:
+    Tournament(RuleVariant, int, int);
+
+    void run();
+    void printReport();
+
+private:
+    RuleVariant ruleVariant;
+    int dealCount;
+    int threadCount;
+    double seconds;
+    std::atomic<int> nextDeal;
+    vector<DealResult> results[STRATEGY_COUNT];
+
+    void runThread();
+};
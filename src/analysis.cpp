@@ -0,0 +1,244 @@
+#include "analysis.hpp"
+#include "bitboard.hpp"
+
+constexpr int WON_SCORE = 1 << 20;
+
+int scorePosition(const Board& board)
+{
+    int score = 0;
+    for (int i = 0; i < FOUNDATION_COUNT; i++)
+    {
+        score += 10 * board.getFoundationLength(i);
+    }
+    for (int i = 0; i < STACK_COUNT; i++)
+    {
+        score -= 5 * board.getHiddenCardCount(i);
+    }
+    // Cards still in the stock or the waste
+    score -= board.getRemainingUnusedCardCount() + board.getWasteLength();
+    return score;
+}
+
+MoveSearch::MoveSearch()
+{
+    this->boards.resize(ANALYSIS_MAX_DEPTH + 1);
+    this->nodeCount = 0;
+    this->nodeBudget = 0;
+    this->searchGeneration = 0;
+}
+
+bool MoveSearch::findBestMove(const Board& board, const RuleSet* rules, int nodeBudget, Move* move, bool* hasMove)
+{
+    Move moves[MAX_MOVES];
+    Bitboard bitboard;
+    Board firstBoard = board;
+    *hasMove = rules->generateMoves(&firstBoard, &bitboard, moves) > 0;
+    if (!*hasMove)
+    {
+        return true;
+    }
+    return searchDeepening(board, rules, nodeBudget, move) != INT32_MIN;
+}
+
+int MoveSearch::scoreBestLine(const Board& board, const RuleSet* rules, int nodeBudget)
+{
+    int score = searchDeepening(board, rules, nodeBudget, nullptr);
+    return score != INT32_MIN ? score : scorePosition(board);
+}
+
+void MoveSearch::setCancelGeneration(const std::atomic<uint64_t>* generation, uint64_t searchGeneration)
+{
+    this->generation = generation;
+    this->searchGeneration = searchGeneration;
+}
+
+// Best score of the last depth searched in full, INT32_MIN if there is none
+int MoveSearch::searchDeepening(const Board& board, const RuleSet* rules, int nodeBudget, Move* move)
+{
+    this->boards[0] = board;
+    this->nodeCount = 0;
+    this->nodeBudget = nodeBudget;
+
+    int bestScore = INT32_MIN;
+    for (int depth = 1; depth <= ANALYSIS_MAX_DEPTH; depth++)
+    {
+        Move bestMove;
+        int score = searchDepth(0, depth, rules, move != nullptr ? &bestMove : nullptr);
+        if (score == INT32_MIN)
+        {
+            // Out of budget or cancelled, the previous depth stands
+            break;
+        }
+
+        bestScore = score;
+        if (move != nullptr)
+        {
+            *move = bestMove;
+        }
+        if (score >= WON_SCORE)
+        {
+            break;
+        }
+    }
+    return bestScore;
+}
+
+// Best score reachable within depth moves, INT32_MIN once the search is cancelled or out of budget
+int MoveSearch::searchDepth(int ply, int depth, const RuleSet* rules, Move* bestMove)
+{
+    Board* board = &this->boards[ply];
+    if (++this->nodeCount > this->nodeBudget || (this->nodeCount % ANALYSIS_CANCEL_INTERVAL == 0 && getIsCancelled()))
+    {
+        return INT32_MIN;
+    }
+
+    // A won line scores higher the sooner it wins
+    bool isWon = true;
+    for (int i = 0; i < FOUNDATION_COUNT && isWon; i++)
+    {
+        isWon = board->getFoundationLength(i) == MAX_VALUE;
+    }
+    if (isWon)
+    {
+        return WON_SCORE + ANALYSIS_MAX_DEPTH - ply;
+    }
+
+    // Stopping is a line too, except at the first position where a move is asked for
+    int bestScore = scorePosition(*board);
+    if (depth == 0)
+    {
+        return bestScore;
+    }
+
+    Move moves[MAX_MOVES];
+    Bitboard bitboard;
+    int moveCount = rules->generateMoves(board, &bitboard, moves);
+    if (bestMove != nullptr && moveCount > 0)
+    {
+        *bestMove = moves[0];
+        bestScore = INT32_MIN + 1;
+    }
+
+    Board* nextBoard = &this->boards[ply + 1];
+    for (int i = 0; i < moveCount; i++)
+    {
+        *nextBoard = *board;
+        rules->applyMove(nextBoard, moves[i]);
+        int score = searchDepth(ply + 1, depth - 1, rules, nullptr);
+        if (score == INT32_MIN)
+        {
+            return INT32_MIN;
+        }
+        // Ties go to the earlier move, foundation moves come first
+        if (score > bestScore)
+        {
+            bestScore = score;
+            if (bestMove != nullptr)
+            {
+                *bestMove = moves[i];
+            }
+        }
+    }
+    return bestScore;
+}
+
+bool MoveSearch::getIsCancelled()
+{
+    return this->generation != nullptr && *this->generation != this->searchGeneration;
+}
+
+AnalysisWorker::AnalysisWorker()
+{
+    this->generation = 0;
+    this->hasPendingSnapshot = false;
+    this->isSearching = false;
+    // No result until the first analysis
+    this->resultGeneration = UINT64_MAX;
+    this->resultHasMove = false;
+    this->isStopping = false;
+
+    this->thread = std::thread(&AnalysisWorker::run, this);
+}
+
+AnalysisWorker::~AnalysisWorker()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->isStopping = true;
+    }
+    cancel();
+    this->condition.notify_one();
+    this->thread.join();
+}
+
+// Must be called from the thread that owns the board, the board is copied before this returns
+void AnalysisWorker::requestAnalysis(const Board& board, RuleVariant ruleVariant)
+{
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->pendingSnapshot.board = board;
+        this->pendingSnapshot.ruleVariant = ruleVariant;
+        this->pendingSnapshot.generation = ++this->generation;
+        this->hasPendingSnapshot = true;
+    }
+    this->condition.notify_one();
+}
+
+// Any analysis still running stops at its next check, and its result is dropped
+void AnalysisWorker::cancel()
+{
+    ++this->generation;
+}
+
+bool AnalysisWorker::pollHint(Move* move, bool* hasMove)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (this->resultGeneration != this->generation)
+    {
+        return false;
+    }
+
+    *move = this->resultMove;
+    *hasMove = this->resultHasMove;
+    return true;
+}
+
+bool AnalysisWorker::getIsBusy()
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->hasPendingSnapshot || this->isSearching;
+}
+
+void AnalysisWorker::run()
+{
+    std::unique_lock<std::mutex> lock(this->mutex);
+    while (true)
+    {
+        this->condition.wait(lock, [this] { return this->hasPendingSnapshot || this->isStopping; });
+        if (this->isStopping)
+        {
+            return;
+        }
+
+        // Only the latest position is searched, an older request is replaced before it starts
+        std::swap(this->pendingSnapshot, this->searchSnapshot);
+        this->hasPendingSnapshot = false;
+        this->isSearching = true;
+        lock.unlock();
+
+        Move move = { UNUSED_PILE, UNUSED_PILE, 1 };
+        bool hasMove = false;
+        this->search.setCancelGeneration(&this->generation, this->searchSnapshot.generation);
+        bool isFinished = this->search.findBestMove(this->searchSnapshot.board, getRuleSet(this->searchSnapshot.ruleVariant),
+            ANALYSIS_NODE_BUDGET, &move, &hasMove);
+
+        lock.lock();
+        this->isSearching = false;
+        if (isFinished && this->searchSnapshot.generation == this->generation)
+        {
+            this->resultGeneration = this->searchSnapshot.generation;
+            this->resultMove = move;
+            this->resultHasMove = hasMove;
+        }
+    }
+}
@@ -0,0 +1,440 @@
+#include "archive.hpp"
+#include "board.hpp"
+#include "gamecodec.hpp"
+#include "persistence.hpp"
+
+#include <cstring>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+constexpr char ARCHIVE_BLOCK_MAGIC[4] = { 'A', 'R', 'C', 'B' };
+constexpr char ARCHIVE_FOOTER_MAGIC[4] = { 'A', 'R', 'C', 'F' };
+
+// Bytes of the fixed width columns of one record
+constexpr int ARCHIVE_RECORD_LENGTH = 4 * 4 + 2 + MAX_CARDS;
+
+static uint64_t getBlockLength(uint32_t recordCount, uint32_t movesLength)
+{
+    uint64_t blockLength = ARCHIVE_BLOCK_HEADER_LENGTH + static_cast<uint64_t>(recordCount) * ARCHIVE_RECORD_LENGTH + movesLength;
+    return (blockLength + 7) & ~static_cast<uint64_t>(7);
+}
+
+// Blocks of an older version have other columns, and are not read
+static bool isBlockHeader(const char* header)
+{
+    uint32_t version;
+    memcpy(&version, header + 12, 4);
+    return memcmp(header, ARCHIVE_BLOCK_MAGIC, sizeof(ARCHIVE_BLOCK_MAGIC)) == 0 && version == ARCHIVE_VERSION;
+}
+
+// Record moves must lie inside the block, in the order of the records
+static bool hasValidMoveOffsets(const ArchiveBlock& block)
+{
+    uint32_t movesStart = 0;
+    for (int i = 0; i < block.recordCount; i++)
+    {
+        if (block.moveOffsets[i] < movesStart || block.moveOffsets[i] > block.movesLength)
+        {
+            return false;
+        }
+        movesStart = block.moveOffsets[i];
+    }
+    return true;
+}
+
+// Columns of the block starting at blockData, in the order they are written
+static ArchiveBlock getBlockColumns(const char* blockData, uint32_t recordCount, uint32_t movesLength)
+{
+    ArchiveBlock block;
+    block.recordCount = recordCount;
+    const char* column = blockData + ARCHIVE_BLOCK_HEADER_LENGTH;
+    block.seeds = reinterpret_cast<const uint32_t*>(column);
+    column += 4 * recordCount;
+    block.moveCounts = reinterpret_cast<const uint32_t*>(column);
+    column += 4 * recordCount;
+    block.durations = reinterpret_cast<const uint32_t*>(column);
+    column += 4 * recordCount;
+    block.moveOffsets = reinterpret_cast<const uint32_t*>(column);
+    column += 4 * recordCount;
+    block.results = reinterpret_cast<const uint8_t*>(column);
+    column += recordCount;
+    block.ruleVariants = reinterpret_cast<const uint8_t*>(column);
+    column += recordCount;
+    block.deals = column;
+    column += MAX_CARDS * recordCount;
+    block.moves = column;
+    block.movesLength = movesLength;
+    return block;
+}
+
+ArchiveWriter::ArchiveWriter()
+{
+    this->dataLength = 0;
+    this->codec = new GameCodec();
+    clearBlock();
+}
+
+ArchiveWriter::~ArchiveWriter()
+{
+    close();
+    delete this->codec;
+    this->codec = nullptr;
+}
+
+// Opens an archive for appending, creating it if needed
+bool ArchiveWriter::open(const char* fileName)
+{
+    close();
+
+    this->file = fopen(fileName, "r+b");
+    if (this->file == nullptr)
+    {
+        this->file = fopen(fileName, "w+b");
+    }
+    if (this->file == nullptr)
+    {
+        return false;
+    }
+
+    if (!readIndex())
+    {
+        // Not an archive, leave the file as it is
+        fclose(this->file);
+        this->file = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void ArchiveWriter::append(const GameRecord& record)
+{
+    // Games whose moves do not replay from the deal are kept, but without their seed
+    uint32_t seed = record.history != nullptr && static_cast<uint32_t>(record.history->getLength()) == record.moveCount ? record.seed : 0;
+    this->recordMoves.clear();
+    if (record.history != nullptr)
+    {
+        for (int i = 0; i < record.history->getLength(); i++)
+        {
+            this->recordMoves.push_back(record.history->getMove(i));
+        }
+    }
+    if (seed != 0 && !this->codec->encode(seed, record.ruleVariant, this->recordMoves.data(), this->recordMoves.size(), &this->recordData))
+    {
+        seed = 0;
+    }
+
+    this->seeds.push_back(seed);
+    this->moveCounts.push_back(record.moveCount);
+    this->durations.push_back(record.durationMs);
+    this->moveOffsets.push_back(this->moves.size());
+    this->results.push_back(record.result);
+    this->ruleVariants.push_back(record.ruleVariant);
+
+    // The deal in the same card encoding as a save file
+    int dealIndex = this->deals.size();
+    this->deals.resize(dealIndex + MAX_CARDS, -1);
+    if (record.seed != 0)
+    {
+        Card* deck[MAX_CARDS];
+        Board::shuffleDeck(record.seed, deck);
+        for (int i = 0; i < MAX_CARDS; i++)
+        {
+            Persistence::writeCardData(deck[i], true, this->deals.data(), &dealIndex);
+        }
+    }
+
+    if (seed != 0)
+    {
+        this->moves.insert(this->moves.end(), this->recordData.begin(), this->recordData.end());
+    }
+    else if (record.history != nullptr)
+    {
+        int movesIndex = this->moves.size();
+        this->moves.resize(movesIndex + record.history->getEncodedLength());
+        record.history->encode(this->moves.data() + movesIndex);
+    }
+
+    this->recordCount++;
+    if (this->recordCount >= ARCHIVE_BLOCK_RECORDS)
+    {
+        flush();
+    }
+}
+
+// Writes the buffered records as a block, followed by the footer
+// The block only ends once it is full, until then it is written again in place by every flush
+bool ArchiveWriter::flush()
+{
+    if (this->file == nullptr || this->recordCount == 0)
+    {
+        return this->file != nullptr;
+    }
+
+    ArchiveBlockInfo blockInfo = { this->dataLength, static_cast<uint32_t>(this->recordCount), static_cast<uint32_t>(this->moves.size()) };
+    uint64_t blockLength = getBlockLength(blockInfo.recordCount, blockInfo.movesLength);
+
+    char header[ARCHIVE_BLOCK_HEADER_LENGTH] = { 0 };
+    memcpy(header, ARCHIVE_BLOCK_MAGIC, sizeof(ARCHIVE_BLOCK_MAGIC));
+    memcpy(header + 4, &blockInfo.recordCount, 4);
+    memcpy(header + 8, &blockInfo.movesLength, 4);
+    uint32_t version = ARCHIVE_VERSION;
+    memcpy(header + 12, &version, 4);
+    char padding[8] = { 0 };
+    uint64_t paddingLength = blockLength - ARCHIVE_BLOCK_HEADER_LENGTH - this->recordCount * ARCHIVE_RECORD_LENGTH - this->moves.size();
+
+    // The new block overwrites the old footer
+    bool hasWritten = fseek(this->file, this->dataLength, SEEK_SET) == 0 &&
+        fwrite(header, 1, ARCHIVE_BLOCK_HEADER_LENGTH, this->file) == ARCHIVE_BLOCK_HEADER_LENGTH &&
+        fwrite(this->seeds.data(), 4, this->recordCount, this->file) == static_cast<size_t>(this->recordCount) &&
+        fwrite(this->moveCounts.data(), 4, this->recordCount, this->file) == static_cast<size_t>(this->recordCount) &&
+        fwrite(this->durations.data(), 4, this->recordCount, this->file) == static_cast<size_t>(this->recordCount) &&
+        fwrite(this->moveOffsets.data(), 4, this->recordCount, this->file) == static_cast<size_t>(this->recordCount) &&
+        fwrite(this->results.data(), 1, this->recordCount, this->file) == static_cast<size_t>(this->recordCount) &&
+        fwrite(this->ruleVariants.data(), 1, this->recordCount, this->file) == static_cast<size_t>(this->recordCount) &&
+        fwrite(this->deals.data(), 1, this->deals.size(), this->file) == this->deals.size() &&
+        fwrite(this->moves.data(), 1, this->moves.size(), this->file) == this->moves.size() &&
+        fwrite(padding, 1, paddingLength, this->file) == paddingLength;
+
+    uint32_t trailer[3] = { static_cast<uint32_t>(this->blockInfos.size() + 1), ARCHIVE_VERSION, 0 };
+    memcpy(&trailer[2], ARCHIVE_FOOTER_MAGIC, sizeof(ARCHIVE_FOOTER_MAGIC));
+    hasWritten = hasWritten && fwrite(this->blockInfos.data(), sizeof(ArchiveBlockInfo), this->blockInfos.size(), this->file) == this->blockInfos.size() &&
+        fwrite(&blockInfo, sizeof(ArchiveBlockInfo), 1, this->file) == 1 &&
+        fwrite(trailer, 1, ARCHIVE_TRAILER_LENGTH, this->file) == ARCHIVE_TRAILER_LENGTH &&
+        fflush(this->file) == 0;
+
+    // A full block is dropped even if it could not be written, the records would pile up otherwise
+    if (this->recordCount >= ARCHIVE_BLOCK_RECORDS)
+    {
+        if (hasWritten)
+        {
+            this->blockInfos.push_back(blockInfo);
+            this->dataLength += blockLength;
+        }
+        clearBlock();
+    }
+    return hasWritten;
+}
+
+void ArchiveWriter::close()
+{
+    if (this->file == nullptr)
+    {
+        return;
+    }
+
+    flush();
+    fclose(this->file);
+    this->file = nullptr;
+    this->blockInfos.clear();
+    this->dataLength = 0;
+    clearBlock();
+}
+
+// Reads the footer, or rebuilds it from the block headers if it was never written
+bool ArchiveWriter::readIndex()
+{
+    this->blockInfos.clear();
+    this->dataLength = 0;
+
+    if (fseek(this->file, 0, SEEK_END) != 0)
+    {
+        return false;
+    }
+    uint64_t fileLength = ftell(this->file);
+
+    uint32_t trailer[3];
+    if (fileLength >= ARCHIVE_TRAILER_LENGTH && fseek(this->file, fileLength - ARCHIVE_TRAILER_LENGTH, SEEK_SET) == 0 &&
+        fread(trailer, 1, ARCHIVE_TRAILER_LENGTH, this->file) == ARCHIVE_TRAILER_LENGTH &&
+        memcmp(&trailer[2], ARCHIVE_FOOTER_MAGIC, sizeof(ARCHIVE_FOOTER_MAGIC)) == 0 && trailer[1] == ARCHIVE_VERSION &&
+        fileLength >= ARCHIVE_TRAILER_LENGTH + static_cast<uint64_t>(trailer[0]) * sizeof(ArchiveBlockInfo))
+    {
+        uint64_t footerOffset = fileLength - ARCHIVE_TRAILER_LENGTH - static_cast<uint64_t>(trailer[0]) * sizeof(ArchiveBlockInfo);
+        this->blockInfos.resize(trailer[0]);
+        if (fseek(this->file, footerOffset, SEEK_SET) == 0 &&
+            fread(this->blockInfos.data(), sizeof(ArchiveBlockInfo), trailer[0], this->file) == trailer[0])
+        {
+            this->dataLength = footerOffset;
+            return true;
+        }
+        this->blockInfos.clear();
+    }
+
+    // Walk the blocks from the start, anything after the last whole block is dropped
+    char header[ARCHIVE_BLOCK_HEADER_LENGTH];
+    while (fseek(this->file, this->dataLength, SEEK_SET) == 0 &&
+        fread(header, 1, ARCHIVE_BLOCK_HEADER_LENGTH, this->file) == ARCHIVE_BLOCK_HEADER_LENGTH && isBlockHeader(header))
+    {
+        ArchiveBlockInfo blockInfo = { this->dataLength, 0, 0 };
+        memcpy(&blockInfo.recordCount, header + 4, 4);
+        memcpy(&blockInfo.movesLength, header + 8, 4);
+        uint64_t blockLength = getBlockLength(blockInfo.recordCount, blockInfo.movesLength);
+        if (this->dataLength + blockLength > fileLength)
+        {
+            break;
+        }
+        this->blockInfos.push_back(blockInfo);
+        this->dataLength += blockLength;
+    }
+
+    // An empty file is a new archive, anything else must start with a block
+    return fileLength == 0 || !this->blockInfos.empty();
+}
+
+void ArchiveWriter::clearBlock()
+{
+    this->recordCount = 0;
+    this->seeds.clear();
+    this->moveCounts.clear();
+    this->durations.clear();
+    this->moveOffsets.clear();
+    this->results.clear();
+    this->ruleVariants.clear();
+    this->deals.clear();
+    this->moves.clear();
+}
+
+ArchiveReader::ArchiveReader()
+{
+    this->dataLength = 0;
+    this->blockCount = 0;
+}
+
+ArchiveReader::~ArchiveReader()
+{
+    close();
+}
+
+// Maps the whole archive read only, blocks are then read in place
+bool ArchiveReader::open(const char* fileName)
+{
+    close();
+
+#ifdef _WIN32
+    std::ifstream archiveFile(fileName, std::ios::binary);
+    if (!archiveFile.is_open())
+    {
+        return false;
+    }
+    archiveFile.seekg(0, archiveFile.end);
+    this->dataLength = archiveFile.tellg();
+    archiveFile.seekg(0, archiveFile.beg);
+    this->buffer.resize(this->dataLength);
+    archiveFile.read(this->buffer.data(), this->dataLength);
+    this->data = this->buffer.data();
+#else
+    int fileDescriptor = ::open(fileName, O_RDONLY);
+    if (fileDescriptor < 0)
+    {
+        return false;
+    }
+    struct stat fileStat;
+    if (fstat(fileDescriptor, &fileStat) != 0 || fileStat.st_size < ARCHIVE_TRAILER_LENGTH)
+    {
+        ::close(fileDescriptor);
+        return false;
+    }
+    this->dataLength = fileStat.st_size;
+    void* mapping = mmap(nullptr, this->dataLength, PROT_READ, MAP_SHARED, fileDescriptor, 0);
+    ::close(fileDescriptor);
+    if (mapping == MAP_FAILED)
+    {
+        this->dataLength = 0;
+        return false;
+    }
+    this->data = static_cast<const char*>(mapping);
+    // Columns are scanned front to back
+    madvise(mapping, this->dataLength, MADV_SEQUENTIAL);
+#endif
+
+    if (this->dataLength < ARCHIVE_TRAILER_LENGTH)
+    {
+        close();
+        return false;
+    }
+    const uint32_t* trailer = reinterpret_cast<const uint32_t*>(this->data + this->dataLength - ARCHIVE_TRAILER_LENGTH);
+    uint64_t indexLength = static_cast<uint64_t>(trailer[0]) * sizeof(ArchiveBlockInfo);
+    if (memcmp(&trailer[2], ARCHIVE_FOOTER_MAGIC, sizeof(ARCHIVE_FOOTER_MAGIC)) != 0 || trailer[1] != ARCHIVE_VERSION ||
+        indexLength > this->dataLength - ARCHIVE_TRAILER_LENGTH)
+    {
+        close();
+        return false;
+    }
+
+    uint64_t footerOffset = this->dataLength - ARCHIVE_TRAILER_LENGTH - indexLength;
+    this->blockInfos = reinterpret_cast<const ArchiveBlockInfo*>(this->data + footerOffset);
+    this->blockCount = trailer[0];
+    for (int i = 0; i < this->blockCount; i++)
+    {
+        if (this->blockInfos[i].offset + getBlockLength(this->blockInfos[i].recordCount, this->blockInfos[i].movesLength) > footerOffset ||
+            !hasValidMoveOffsets(getBlock(i)))
+        {
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void ArchiveReader::close()
+{
+#ifdef _WIN32
+    this->buffer.clear();
+#else
+    if (this->data != nullptr)
+    {
+        munmap(const_cast<char*>(this->data), this->dataLength);
+    }
+#endif
+    this->data = nullptr;
+    this->dataLength = 0;
+    this->blockInfos = nullptr;
+    this->blockCount = 0;
+}
+
+int ArchiveReader::getBlockCount()
+{
+    return this->blockCount;
+}
+
+uint64_t ArchiveReader::getRecordCount()
+{
+    uint64_t recordCount = 0;
+    for (int i = 0; i < this->blockCount; i++)
+    {
+        recordCount += this->blockInfos[i].recordCount;
+    }
+    return recordCount;
+}
+
+ArchiveBlock ArchiveReader::getBlock(int blockIndex)
+{
+    const ArchiveBlockInfo& blockInfo = this->blockInfos[blockIndex];
+    return getBlockColumns(this->data + blockInfo.offset, blockInfo.recordCount, blockInfo.movesLength);
+}
+
+// Games and wins per bucket of bucketSize moves, only the move count and result columns are touched
+void ArchiveReader::countWinsByMoveCount(uint32_t bucketSize, vector<uint64_t>* games, vector<uint64_t>* wins)
+{
+    games->clear();
+    wins->clear();
+    for (int i = 0; i < this->blockCount; i++)
+    {
+        ArchiveBlock block = getBlock(i);
+        for (int j = 0; j < block.recordCount; j++)
+        {
+            uint32_t bucket = block.moveCounts[j] / bucketSize;
+            if (bucket >= games->size())
+            {
+                games->resize(bucket + 1, 0);
+                wins->resize(bucket + 1, 0);
+            }
+            (*games)[bucket]++;
+            (*wins)[bucket] += block.results[j] == GameResult::WON;
+        }
+    }
+}
@@ -0,0 +1,272 @@
+#include "autosave.hpp"
+#include "logic.hpp"
+
+constexpr char JOURNAL_MAGIC[JOURNAL_MAGIC_LENGTH] = { 'S', 'O', 'L', 'J' };
+
+Autosave::Autosave(MoveHistory* history, Persistence* persistence, Logic* logic)
+{
+    this->history = history;
+    this->persistence = persistence;
+    this->logic = logic;
+    this->saveWorker = new SaveWorker(persistence);
+
+    this->isCompacting = false;
+    this->historyIndex = 0;
+    this->journalMoveCount = 0;
+    this->pendingMoveCount = 0;
+    this->pendingData.reserve(2 * JOURNAL_COMMIT_MOVES);
+}
+
+Autosave::~Autosave()
+{
+    stop();
+    delete this->saveWorker;
+    this->saveWorker = nullptr;
+    this->history = nullptr;
+    this->persistence = nullptr;
+    this->logic = nullptr;
+}
+
+// Restores the last autosaved game, returns false if there is none
+bool Autosave::recover()
+{
+    if (!this->persistence->loadFile(AUTOSAVE_SNAPSHOT_NAME))
+    {
+        return false;
+    }
+
+    // Moves after the first bad one are lost, but the game up to there is still good
+    replayJournal();
+
+    // Carry on with a fresh journal on top of the recovered position
+    compact();
+    return true;
+}
+
+// Starts autosaving the current game from a snapshot of it
+void Autosave::onNewGame()
+{
+    stop();
+    compact();
+}
+
+// Journals the moves made since the last update
+void Autosave::update()
+{
+    finishCompaction(false);
+    if (this->journalFile == nullptr && !this->isCompacting)
+    {
+        return;
+    }
+
+    int historyLength = this->history->getLength();
+    for (; this->historyIndex < historyLength; this->historyIndex++)
+    {
+        if (this->pendingMoveCount == 0)
+        {
+            this->pendingSince = std::chrono::steady_clock::now();
+        }
+
+        char moveData[2];
+        int moveLength = MoveHistory::encodeMove(this->history->getMove(this->historyIndex), moveData);
+        this->pendingData.insert(this->pendingData.end(), moveData, moveData + moveLength);
+        this->pendingMoveCount++;
+    }
+
+    // Moves made after the snapshot that is being written wait for its journal
+    if (this->journalFile != nullptr && (this->pendingMoveCount >= JOURNAL_COMMIT_MOVES || getCommitDelay() == 0))
+    {
+        commit();
+    }
+    if (this->journalFile != nullptr && this->journalMoveCount >= JOURNAL_COMPACT_MOVES)
+    {
+        compact();
+    }
+}
+
+// Commits the pending moves and closes the journal, once a snapshot still being written is in place
+void Autosave::stop()
+{
+    finishCompaction(true);
+    if (this->journalFile == nullptr)
+    {
+        return;
+    }
+
+    commit();
+    if (this->journalFile != nullptr)
+    {
+        fclose(this->journalFile);
+        this->journalFile = nullptr;
+    }
+}
+
+// The game is over, so there is nothing left to recover
+void Autosave::discard()
+{
+    stop();
+    remove(AUTOSAVE_SNAPSHOT_NAME);
+    remove(AUTOSAVE_JOURNAL_NAME);
+}
+
+int Autosave::getCommitDelay()
+{
+    if (this->isCompacting)
+    {
+        return SAVE_POLL_INTERVAL_MS;
+    }
+    if (this->journalFile == nullptr || this->pendingMoveCount == 0)
+    {
+        return -1;
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - this->pendingSince);
+    int delay = JOURNAL_COMMIT_INTERVAL_MS - static_cast<int>(elapsed.count());
+    return delay > 0 ? delay : 0;
+}
+
+// Group commit, one write and one fsync for all pending moves
+bool Autosave::commit()
+{
+    if (this->pendingMoveCount == 0)
+    {
+        return true;
+    }
+
+    bool hasWritten = fwrite(this->pendingData.data(), 1, this->pendingData.size(), this->journalFile) == this->pendingData.size() &&
+        Persistence::syncFile(this->journalFile);
+
+    this->journalMoveCount += this->pendingMoveCount;
+    this->pendingMoveCount = 0;
+    this->pendingData.clear();
+
+    if (!hasWritten)
+    {
+        // Stop journaling rather than leave a gap in it, the snapshot and the journal so far are still good
+        fclose(this->journalFile);
+        this->journalFile = nullptr;
+    }
+    return hasWritten;
+}
+
+/*
+Writes the whole game to a new snapshot on the worker, which then starts an empty journal for it
+The snapshot is renamed into place only once it is on disk, and the journal only after it. If we crash before
+the new journal is in place, the old journal names the old snapshot's checksum and is ignored
+Moves made until then are only in memory, just like moves waiting for a group commit
+*/
+void Autosave::compact()
+{
+    // Only one snapshot at a time, so the journal that is opened is always the one of the last snapshot
+    finishCompaction(true);
+    if (this->journalFile != nullptr)
+    {
+        fclose(this->journalFile);
+        this->journalFile = nullptr;
+    }
+    this->historyIndex = this->history->getLength();
+    this->journalMoveCount = 0;
+    this->pendingMoveCount = 0;
+    this->pendingData.clear();
+
+    this->saveWorker->requestSave(AUTOSAVE_SNAPSHOT_NAME, startJournal);
+    this->isCompacting = true;
+}
+
+// Opens the journal of a snapshot the worker has finished, optionally waiting for it
+void Autosave::finishCompaction(bool isWaiting)
+{
+    if (!this->isCompacting)
+    {
+        return;
+    }
+    if (isWaiting)
+    {
+        this->saveWorker->wait();
+    }
+
+    bool isSaved;
+    if (!this->saveWorker->pollResult(&isSaved))
+    {
+        return;
+    }
+    this->isCompacting = false;
+    // Without a snapshot there is nothing to journal onto, the last good snapshot and journal stay as they are
+    this->journalFile = isSaved ? fopen(AUTOSAVE_JOURNAL_NAME, "ab") : nullptr;
+}
+
+// Runs on the save worker, replaces the journal with an empty one for the snapshot with this checksum
+bool Autosave::startJournal(uint32_t checksum)
+{
+    FILE* journalFile = fopen(AUTOSAVE_JOURNAL_TEMP_NAME, "wb");
+    if (journalFile == nullptr)
+    {
+        return false;
+    }
+
+    char header[JOURNAL_HEADER_LENGTH];
+    for (int i = 0; i < JOURNAL_MAGIC_LENGTH; i++)
+    {
+        header[i] = JOURNAL_MAGIC[i];
+    }
+    for (int i = 0; i < 4; i++)
+    {
+        header[JOURNAL_MAGIC_LENGTH + i] = (checksum >> (24 - 8 * i)) & 0xFF;
+    }
+    bool isWritten = fwrite(header, 1, JOURNAL_HEADER_LENGTH, journalFile) == JOURNAL_HEADER_LENGTH;
+    fclose(journalFile);
+    return isWritten && Persistence::replaceFile(AUTOSAVE_JOURNAL_TEMP_NAME, AUTOSAVE_JOURNAL_NAME);
+}
+
+// Applies the journaled moves to the loaded snapshot, up to the first one that is torn or illegal
+bool Autosave::replayJournal()
+{
+    std::ifstream journal(AUTOSAVE_JOURNAL_NAME, std::ios::binary);
+    if (!journal.is_open())
+    {
+        return false;
+    }
+
+    journal.seekg(0, journal.end);
+    int journalLength = journal.tellg();
+    journal.seekg(0, journal.beg);
+    if (journalLength < JOURNAL_HEADER_LENGTH || journalLength > MAX_SAVEFILE_LENGTH)
+    {
+        return false;
+    }
+
+    vector<char> journalData(journalLength);
+    journal.read(journalData.data(), journalLength);
+    if (journal.gcount() != journalLength)
+    {
+        return false;
+    }
+
+    uint32_t checksum = 0;
+    for (int i = 0; i < JOURNAL_MAGIC_LENGTH; i++)
+    {
+        if (journalData[i] != JOURNAL_MAGIC[i])
+        {
+            return false;
+        }
+        checksum = (checksum << 8) | static_cast<unsigned char>(journalData[JOURNAL_MAGIC_LENGTH + i]);
+    }
+    if (checksum != this->persistence->getLastChecksum())
+    {
+        // Journal of an older snapshot
+        return false;
+    }
+
+    int journalIndex = JOURNAL_HEADER_LENGTH;
+    while (journalIndex < journalLength)
+    {
+        Move move;
+        int moveLength = MoveHistory::decodeMove(journalData.data() + journalIndex, journalLength - journalIndex, &move);
+        if (moveLength == 0 || !this->logic->applyMove(move))
+        {
+            return false;
+        }
+        journalIndex += moveLength;
+    }
+    return true;
+}
@@ -0,0 +1,121 @@
+#include "bench.hpp"
+#include "replay.hpp"
+#include "lockstep.hpp"
+#include "rules.hpp"
+
+#include <chrono>
+#include <random>
+
+// The playouts of LockstepSimulator one game at a time through the game rules, the baseline it is measured against
+static void playBoardPlayouts(int games, RuleVariant ruleVariant, uint64_t* wins, uint64_t* moveCount)
+{
+    int drawCount = getRuleSet(ruleVariant)->drawCount;
+    Replay replay;
+    Move moves[MAX_MOVES];
+    Move bestMoves[MAX_MOVES];
+    std::mt19937 rng(1);
+    for (int i = 1; i <= games; i++)
+    {
+        replay.deal(i, ruleVariant);
+        int drawStreak = 0;
+        for (int j = 0; j < LOCKSTEP_MAX_MOVES && !replay.isGameWon(); j++)
+        {
+            const Board& board = *replay.getBoard();
+            int legalMoveCount = replay.generateMoves(moves);
+            int bestPriority = LockstepPriority::NO_MOVE;
+            int bestMoveCount = 0;
+            for (int k = 0; k < legalMoveCount; k++)
+            {
+                int moveNumber = getLockstepMoveNumber(board, moves[k]);
+                int priority = moveNumber >= 0 ? getLockstepPriority(moveNumber) : LockstepPriority::NO_MOVE;
+                if (priority > bestPriority)
+                {
+                    bestPriority = priority;
+                    bestMoveCount = 0;
+                }
+                if (priority == bestPriority && priority != LockstepPriority::NO_MOVE)
+                {
+                    bestMoves[bestMoveCount++] = moves[k];
+                }
+            }
+            if (bestMoveCount == 0)
+            {
+                break;
+            }
+
+            replay.applyMove(bestMoves[rng() % bestMoveCount]);
+            (*moveCount)++;
+            drawStreak = bestPriority == LockstepPriority::DRAW_PRIORITY ? drawStreak + 1 : 0;
+            if (drawStreak > 2 * ((board.getRemainingUnusedCardCount() + board.getWasteLength()) / drawCount + 2))
+            {
+                break;
+            }
+        }
+        *wins += replay.isGameWon() ? 1 : 0;
+    }
+}
+
+/*
+Random playouts of the same deals in lockstep and one at a time, then every lockstep game is replayed through the game rules
+The simulator has no redeal limit, so the variant must not be a Vegas one
+*/
+int printLockstep(int games, RuleVariant ruleVariant)
+{
+    int drawCount = getRuleSet(ruleVariant)->drawCount;
+    vector<uint32_t> seeds(games);
+    for (int i = 0; i < games; i++)
+    {
+        seeds[i] = i + 1;
+    }
+
+    LockstepSimulator simulator(drawCount);
+    auto startTime = std::chrono::steady_clock::now();
+    simulator.deal(seeds.data(), games);
+    int stepCount = simulator.run();
+    double lockstepSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    uint64_t lockstepWins = 0;
+    uint64_t lockstepMoves = 0;
+    for (int i = 0; i < games; i++)
+    {
+        lockstepWins += simulator.getIsWon(i) ? 1 : 0;
+        lockstepMoves += simulator.getMoveCount(i);
+    }
+
+    uint64_t boardWins = 0;
+    uint64_t boardMoves = 0;
+    startTime = std::chrono::steady_clock::now();
+    playBoardPlayouts(games, ruleVariant, &boardWins, &boardMoves);
+    double boardSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    // Recorded again, so the timed run above does not pay for the move lists
+    simulator.setIsRecording(true);
+    simulator.deal(seeds.data(), games);
+    simulator.run();
+    Replay replay;
+    int errorCount = 0;
+    for (int i = 0; i < games; i++)
+    {
+        const vector<Move>& moves = simulator.getMoves(i);
+        ReplayResult result = replay.run(seeds[i], ruleVariant, moves.data(), moves.size());
+        if (result.illegalMoveIndex >= 0 || result.isWon != simulator.getIsWon(i) || result.appliedMoveCount != simulator.getMoveCount(i))
+        {
+            if (errorCount == 0)
+            {
+                std::cout << "Deal " << seeds[i] << " differs from its replay at move " << result.illegalMoveIndex << std::endl;
+            }
+            errorCount++;
+        }
+    }
+
+    char line[128];
+    std::cout << games << " random playouts, drawing " << drawCount << ", " << stepCount << " lockstep steps" << std::endl;
+    std::cout << "Engine      Playouts/s      Moves/s  Win rate  Avg moves" << std::endl;
+    snprintf(line, sizeof(line), "%-10s %11.0f %12.0f %8.2f%% %10.1f", "Lockstep", games / lockstepSeconds, lockstepMoves / lockstepSeconds,
+        100.0 * lockstepWins / games, static_cast<double>(lockstepMoves) / games);
+    std::cout << line << std::endl;
+    snprintf(line, sizeof(line), "%-10s %11.0f %12.0f %8.2f%% %10.1f", "Board", games / boardSeconds, boardMoves / boardSeconds,
+        100.0 * boardWins / games, static_cast<double>(boardMoves) / games);
+    std::cout << line << std::endl;
+    std::cout << games << " lockstep games replayed, " << errorCount << " errors" << std::endl;
+    return errorCount == 0 ? 0 : 1;
+}
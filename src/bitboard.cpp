@@ -0,0 +1,145 @@
+#include "bitboard.hpp"
+#include "rules.hpp"
+
+void Bitboard::update(Board* board)
+{
+    this->stackTopCards = 0;
+    this->hasEmptyStack = false;
+    for (int i = 0; i < STACK_COUNT; i++)
+    {
+        int stackLength = board->getStackLength(i);
+        this->stackCards[i] = board->getStackCardMask(i);
+        if (stackLength == 0)
+        {
+            this->stackTops[i] = -1;
+            this->hasEmptyStack = true;
+        }
+        else
+        {
+            this->stackTops[i] = getCardId(board->getCardFromStack(i, stackLength - 1));
+            this->stackTopCards |= cardBit(this->stackTops[i]);
+        }
+    }
+
+    Card* wasteCard = board->getCurrentUnusedCard();
+    this->wasteTop = wasteCard != nullptr ? getCardId(wasteCard) : -1;
+    this->hasStockCards = board->getNextUnusedCard() != nullptr;
+    this->redealCount = board->getRedealCount();
+
+    this->foundationTopCards = 0;
+    this->foundationNextCards = 0;
+    for (int i = 0; i < FOUNDATION_COUNT; i++)
+    {
+        int foundationLength = board->getFoundationLength(i);
+        if (foundationLength > 0)
+        {
+            this->foundationTopCards |= cardBit(i * MAX_VALUE + foundationLength - 1);
+        }
+        if (foundationLength < MAX_VALUE)
+        {
+            this->foundationNextCards |= cardBit(i * MAX_VALUE + foundationLength);
+        }
+    }
+}
+
+CardMask Bitboard::getPlaceableCards() const
+{
+    return getTableauChildren(this->stackTopCards);
+}
+
+template <class Rules>
+bool Bitboard::canStackAcceptCard(int stackIndex, int cardId) const
+{
+    int topCardId = this->stackTops[stackIndex];
+    if (topCardId == -1)
+    {
+        return (Rules::EMPTY_STACK_CARDS & cardBit(cardId)) != 0;
+    }
+    return (TABLEAU_ACCEPTORS[cardId] & cardBit(topCardId)) != 0;
+}
+
+/* Moves are always generated in the same order
+1. Unused pile to foundation, then stacks to foundations
+2. Unused pile to stacks
+3. Stacks to stacks, by source stack then card id
+4. Foundations to stacks
+5. Draw/Recycle
+*/
+template <class Rules>
+int Bitboard::generateMoves(Move* moves) const
+{
+    int moveCount = 0;
+    CardMask stackTargets = getPlaceableCards() | (this->hasEmptyStack ? Rules::EMPTY_STACK_CARDS : 0);
+
+    // 1. Every card that can go onto a foundation is in one mask
+    if (this->wasteTop != -1 && (cardBit(this->wasteTop) & this->foundationNextCards))
+    {
+        moves[moveCount++] = { UNUSED_PILE, static_cast<uint8_t>(FIRST_FOUNDATION_PILE + getCardIdSuit(this->wasteTop)), 1 };
+    }
+    CardMask toFoundation = this->stackTopCards & this->foundationNextCards;
+    for (int i = 0; toFoundation != 0 && i < STACK_COUNT; i++)
+    {
+        if (this->stackTops[i] != -1 && (cardBit(this->stackTops[i]) & toFoundation))
+        {
+            moves[moveCount++] = { static_cast<uint8_t>(FIRST_STACK_PILE + i), static_cast<uint8_t>(FIRST_FOUNDATION_PILE + getCardIdSuit(this->stackTops[i])), 1 };
+        }
+    }
+
+    // 2. The waste card only needs the stack scan if some stack accepts it
+    if (this->wasteTop != -1 && (cardBit(this->wasteTop) & stackTargets))
+    {
+        for (int j = 0; j < STACK_COUNT; j++)
+        {
+            if (canStackAcceptCard<Rules>(j, this->wasteTop))
+            {
+                moves[moveCount++] = { UNUSED_PILE, static_cast<uint8_t>(FIRST_STACK_PILE + j), 1 };
+            }
+        }
+    }
+
+    // 3. A face up run is always in descending order, so the number of cards moved follows from the values
+    for (int i = 0; i < STACK_COUNT; i++)
+    {
+        CardMask movable = this->stackCards[i] & stackTargets;
+        while (movable != 0)
+        {
+            int cardId = popLowestCard(&movable);
+            uint8_t count = static_cast<uint8_t>(getCardIdValue(cardId) - getCardIdValue(this->stackTops[i]) + 1);
+            for (int j = 0; j < STACK_COUNT; j++)
+            {
+                if (j != i && canStackAcceptCard<Rules>(j, cardId))
+                {
+                    moves[moveCount++] = { static_cast<uint8_t>(FIRST_STACK_PILE + i), static_cast<uint8_t>(FIRST_STACK_PILE + j), count };
+                }
+            }
+        }
+    }
+
+    // 4. Foundation cards may only go back onto a non-empty stack
+    CardMask fromFoundation = Rules::CAN_MOVE_FROM_FOUNDATION ? this->foundationTopCards & getPlaceableCards() : 0;
+    while (fromFoundation != 0)
+    {
+        int cardId = popLowestCard(&fromFoundation);
+        for (int j = 0; j < STACK_COUNT; j++)
+        {
+            if (this->stackTops[j] != -1 && canStackAcceptCard<Rules>(j, cardId))
+            {
+                moves[moveCount++] = { static_cast<uint8_t>(FIRST_FOUNDATION_PILE + getCardIdSuit(cardId)), static_cast<uint8_t>(FIRST_STACK_PILE + j), 1 };
+            }
+        }
+    }
+
+    // 5. Drawing is legal whenever there is a card left to draw, or to recycle while redeals are left
+    if (this->hasStockCards || (this->wasteTop != -1 && canRedeal<Rules>(this->redealCount)))
+    {
+        moves[moveCount++] = { UNUSED_PILE, UNUSED_PILE, 1 };
+    }
+
+    return moveCount;
+}
+
+// Every rule policy gets its own move generator
+template int Bitboard::generateMoves<StandardRules>(Move*) const;
+template int Bitboard::generateMoves<DrawThreeRules>(Move*) const;
+template int Bitboard::generateMoves<VegasRules>(Move*) const;
+template int Bitboard::generateMoves<VegasDrawThreeRules>(Move*) const;
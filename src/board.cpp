@@ -1,212 +1,286 @@
 #include "board.hpp"
+#include "rules.hpp"
+
+#include <algorithm>
+#include <random>
 
 Board::Board()
 {
     onNewGame();
 }
 
-Board::~Board()
+void Board::onNewGame()
 {
-    cleanup();
-}
+    this->moves = 0;
+    this->seed = 0;
 
-void Board::cleanup()
-{
-    // Clean up the board
     for (int i = 0; i < STACK_COUNT; i++)
     {
-        delete this->stacks[i];
-        this->stacks[i] = nullptr;
+        this->stackLengths[i] = 0;
+        this->hiddenCounts[i] = 0;
+        this->stackMasks[i] = 0;
     }
 
     for (int i = 0; i < FOUNDATION_COUNT; i++)
     {
-        delete this->foundations[i];
-        this->foundations[i] = nullptr;
+        this->foundationLengths[i] = 0;
     }
 
-    delete this->unusedCards;
-    this->unusedCards = nullptr;
+    this->stockBuffer = 0;
+    this->stockLength = 0;
+    this->stockIndex = 0;
+    this->wasteLength = 0;
+    this->redealCount = 0;
 }
 
-void Board::onNewGame()
+// The same seed always gives the same deal
+void Board::dealCards(uint32_t seed)
 {
-    this->unusedCardIndex = -1;
-    this->moves = 0;
+    this->seed = seed;
 
-    // Initialize 7 stacks
-    for (int i = 0; i < STACK_COUNT; i++)
+    Card* deck[MAX_CARDS];
+    shuffleDeck(seed, deck);
+    distributeCards(deck);
+}
+
+// Deal order of a seed, without dealing it
+void Board::shuffleDeck(uint32_t seed, Card* deck[MAX_CARDS])
+{
+    for (int i = 0; i < MAX_CARDS; i++)
     {
-        this->stacks[i] = new vector<Card*>;
+        deck[i] = &DECK[i];
     }
 
-    // Initialize 4 foundations and reserve 13 spaces for each
-    for (int i = 0; i < FOUNDATION_COUNT; i++)
+    // Shuffle the deck using the Fisher-Yates algorithm
+    std::mt19937 rng(seed);
+    for (int i = MAX_CARDS - 1; i > 0; i--)
     {
-        this->foundations[i] = new vector<Card*>;
-        this->foundations[i]->reserve(MAX_VALUE);
+        int j = rng() % (i + 1);
+        std::swap(deck[i], deck[j]);
     }
-
-    // Reserve 24 card pointers for the unusedCards vector
-    this->unusedCards = new vector<Card*>;
-    this->unusedCards->reserve(RESERVED_CARDS);
 }
 
 void Board::distributeCards(Card* deck[MAX_CARDS])
 {
-    // Distribute cards to the stacks
+    // Distribute cards to the stacks, only the top card of each stack is face up
     int cardIndex = 0;
     for (int i = 0; i < STACK_COUNT; i++)
     {
         for (int j = 0; j < i + 1; j++)
         {   
-            Card* card = deck[cardIndex];
-            this->stacks[i]->push_back(card);
-            if (j == i)
-            {
-                card->isFaceUp = true;
-            }
+            this->stacks[i][j] = deck[cardIndex];
             cardIndex++;
         }
+        this->stackLengths[i] = i + 1;
+        this->hiddenCounts[i] = i;
+        this->stackMasks[i] = cardBit(getCardId(this->stacks[i][i]));
     }
 
-    // Distribute the rest of the cards to the unusedCards vector
+    // Distribute the rest of the cards to the stock
+    Card** stock = this->unusedCards[this->stockBuffer];
     for (; cardIndex < MAX_CARDS; cardIndex++)
     {
-        this->unusedCards->push_back(deck[cardIndex]);
+        stock[this->stockLength++] = deck[cardIndex];
     }
 }
 
-void Board::flipTopStackCards()
+void Board::addCardToStack(int stackIndex, Card* card)
 {
-    for (int i = 0; i < STACK_COUNT; i++)
-    {
-        int stackLength = this->stacks[i]->size();
-        if (stackLength > 0)
-        {
-            Card* card = this->stacks[i]->at(stackLength - 1);
-            card->isFaceUp = true;
-        }
-    }
+    this->stacks[stackIndex][this->stackLengths[stackIndex]++] = card;
+    this->stackMasks[stackIndex] |= cardBit(getCardId(card));
 }
 
-void Board::addCardToStack(int stackIndex, Card* card)
+// Only valid while the stack has no face up cards, i.e. when loading a stack from the bottom
+void Board::addHiddenCardToStack(int stackIndex, Card* card)
 {
-    this->stacks[stackIndex]->push_back(card);
-    card->isFaceUp = true;
+    this->stacks[stackIndex][this->stackLengths[stackIndex]++] = card;
+    this->hiddenCounts[stackIndex]++;
 }
 
 Card* Board::removeCardFromStack(int stackIndex)
 {
     // Remove a card from a stack
-    Card* card = this->stacks[stackIndex]->back();
-    this->stacks[stackIndex]->pop_back();
+    int stackLength = --this->stackLengths[stackIndex];
+    Card* card = this->stacks[stackIndex][stackLength];
+    this->stackMasks[stackIndex] &= ~cardBit(getCardId(card));
+
+    if (stackLength < this->hiddenCounts[stackIndex])
+    {
+        // Removed a face down card
+        this->hiddenCounts[stackIndex] = stackLength;
+    }
+    else if (stackLength > 0 && stackLength == this->hiddenCounts[stackIndex])
+    {
+        // The new top card is face down, so flip it right away
+        this->hiddenCounts[stackIndex]--;
+        this->stackMasks[stackIndex] |= cardBit(getCardId(this->stacks[stackIndex][stackLength - 1]));
+    }
     return card;
 }
 
 Card* Board::removeUnusedCard()
 {
-    // Remove an unused card
-    if (this->unusedCardIndex == -1)
+    // Remove the top card of the waste
+    if (this->wasteLength == 0)
     {
         return nullptr;
     }
-    Card* card = this->unusedCards->at(this->unusedCardIndex);
-    this->unusedCards->erase(this->unusedCards->begin() + this->unusedCardIndex);
-    unusedCardIndex--;
-    
-    return card;
+    return this->unusedCards[this->stockBuffer ^ 1][--this->wasteLength];
 }
 
 void Board::addCardToFoundation(int foundationIndex, Card* card)
 {
     // Add a card to a foundation
-    this->foundations[foundationIndex]->push_back(card);
-    card->isFaceUp = true;
+    this->foundations[foundationIndex][this->foundationLengths[foundationIndex]++] = card;
 }
 
 Card* Board::removeCardFromFoundation(int foundationIndex)
 {
     // Remove a card from a foundation
-    Card* card = this->foundations[foundationIndex]->back();
-    this->foundations[foundationIndex]->pop_back();
-
-    return card;
+    return this->foundations[foundationIndex][--this->foundationLengths[foundationIndex]];
 }
 
-int Board::getStackLength(int stackIndex)
+int Board::getStackLength(int stackIndex) const
 {
     // Get the length of a stack
-    return this->stacks[stackIndex]->size();
+    return this->stackLengths[stackIndex];
 }
 
-int Board::getFoundationLength(int foundationIndex)
+int Board::getHiddenCardCount(int stackIndex) const
+{
+    return this->hiddenCounts[stackIndex];
+}
+
+CardMask Board::getStackCardMask(int stackIndex) const
+{
+    return this->stackMasks[stackIndex];
+}
+
+int Board::getFoundationLength(int foundationIndex) const
 {
     // Get the length of a foundation
-    return this->foundations[foundationIndex]->size();
+    return this->foundationLengths[foundationIndex];
 }
 
-Card* Board::getCardFromStack(int stackIndex, int cardIndex)
+Card* Board::getCardFromStack(int stackIndex, int cardIndex) const
 {
     // Get a card from a stack
-    return this->stacks[stackIndex]->at(cardIndex);
+    return this->stacks[stackIndex][cardIndex];
 }
 
-Card* Board::getCardFromFoundation(int foundationIndex, int cardIndex)
+Card* Board::getCardFromFoundation(int foundationIndex, int cardIndex) const
 {
     // Get a card from a foundation
-    return this->foundations[foundationIndex]->at(cardIndex);
+    return this->foundations[foundationIndex][cardIndex];
 }
 
 // This shows the current card that the user can "use"
-Card* Board::getCurrentUnusedCard()
+Card* Board::getCurrentUnusedCard() const
 {
-    // Get the current unused card
-    if (this->unusedCardIndex == -1)
+    // Get the top card of the waste
+    if (this->wasteLength == 0)
     {
         return nullptr;
     }
-    return this->unusedCards->at(this->unusedCardIndex);
+    return this->unusedCards[this->stockBuffer ^ 1][this->wasteLength - 1];
 }
 
-Card* Board::getNextUnusedCard()
+Card* Board::getNextUnusedCard() const
 {
-    // Get the next unused card
-    if (this->unusedCardIndex + 1 >= static_cast<int>(this->unusedCards->size()))
+    // Get the top card of the stock
+    if (this->stockIndex >= this->stockLength)
     {
         return nullptr;
     }
-    return this->unusedCards->at(this->unusedCardIndex + 1);
+    return this->unusedCards[this->stockBuffer][this->stockIndex];
 }
 
+// Draws up to drawCount cards onto the waste, or recycles the waste back into the stock once the stock is empty
 Card* Board::shiftNextUnusedCard()
 {
-    // Hide the last card
-    if (this->unusedCardIndex != -1)
+    if (this->stockIndex >= this->stockLength)
     {
-        this->unusedCards->at(this->unusedCardIndex)->isFaceUp = false;
+        // The stock is exhausted, so every card on the waste becomes the stock again in the same order
+        this->stockBuffer ^= 1;
+        this->stockLength = this->wasteLength;
+        this->stockIndex = 0;
+        this->wasteLength = 0;
+        this->redealCount++;
+        return nullptr;
     }
-    
-    this->unusedCardIndex++;
-    if (this->unusedCardIndex >= static_cast<int>(this->unusedCards->size()))
+
+    Card** stock = this->unusedCards[this->stockBuffer];
+    Card** waste = this->unusedCards[this->stockBuffer ^ 1];
+    int drawEnd = std::min(this->stockIndex + this->drawCount, this->stockLength);
+    for (; this->stockIndex < drawEnd; this->stockIndex++)
     {
-        this->unusedCardIndex = -1;
-        return nullptr;
+        waste[this->wasteLength++] = stock[this->stockIndex];
     }
-    
-    Card* card = this->unusedCards->at(this->unusedCardIndex);
-    card->isFaceUp = true;
 
-    return card;
+    return waste[this->wasteLength - 1];
 }
 
-int Board::getRemainingUnusedCardCount()
+int Board::getRemainingUnusedCardCount() const
 {
-    // Get the remaining unused card count
-    return this->unusedCards->size() - this->unusedCardIndex - 1;
+    // Get the number of cards left in the stock
+    return this->stockLength - this->stockIndex;
 }
 
-int Board::getMoves()
+int Board::getRedealCount() const
+{
+    return this->redealCount;
+}
+
+// Restores the redeal count of a loaded game, the piles do not record it
+void Board::setRedealCount(int redealCount)
+{
+    this->redealCount = redealCount;
+}
+
+int Board::getWasteLength() const
+{
+    return this->wasteLength;
+}
+
+// 0 is the bottom of the waste
+Card* Board::getCardFromWaste(int cardIndex) const
+{
+    return this->unusedCards[this->stockBuffer ^ 1][cardIndex];
+}
+
+// 0 is the next card to be drawn
+Card* Board::getCardFromStock(int cardIndex) const
+{
+    return this->unusedCards[this->stockBuffer][this->stockIndex + cardIndex];
+}
+
+RuleVariant Board::getRuleVariant() const
+{
+    return this->ruleVariant;
+}
+
+void Board::setRuleVariant(RuleVariant variant)
+{
+    this->ruleVariant = variant;
+    this->drawCount = getRuleSet(variant)->drawCount;
+}
+
+int Board::getDrawCount() const
+{
+    return this->drawCount;
+}
+
+uint32_t Board::getSeed() const
+{
+    return this->seed;
+}
+
+void Board::setSeed(uint32_t seed)
+{
+    this->seed = seed;
+}
+
+int Board::getMoves() const
 {
     return this->moves;
 }
@@ -218,19 +292,25 @@ void Board::addMoves()
 
 bool Board::loadUnusedCards(Card** cardOrder, int cardOrderLength, int currUnusedIndex)
 {
-    // Load unused cards
-    for (int i = 0; i < cardOrderLength; i++)
+    if (cardOrderLength > RESERVED_CARDS)
     {
-        Card* card = cardOrder[i];
-        this->unusedCards->push_back(card);
+        return false;
+    }
 
-        // Note: The card is not face up by default. If we are not at the current unused index, we need to set it to face down
-        if (i != currUnusedIndex)
+    // Cards up to and including the current unused index are on the waste, the rest are still in the stock
+    Card** stock = this->unusedCards[this->stockBuffer];
+    Card** waste = this->unusedCards[this->stockBuffer ^ 1];
+    this->stockIndex = 0;
+    for (int i = 0; i < cardOrderLength; i++)
+    {
+        if (i <= currUnusedIndex)
+        {
+            waste[this->wasteLength++] = cardOrder[i];
+        }
+        else
         {
-            card->isFaceUp = false;
+            stock[this->stockLength++] = cardOrder[i];
         }
     }
-    // Set the current unused card index
-    this->unusedCardIndex = currUnusedIndex;
     return true;
-}
\ No newline at end of file
+}
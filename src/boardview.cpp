@@ -0,0 +1,135 @@
+#include "boardview.hpp"
+
+BoardView::BoardView()
+{
+    this->moves = 0;
+    this->hasNextUnused = false;
+    this->isThoughtful = false;
+}
+
+void BoardView::update(Board* board)
+{
+    this->moves = board->getMoves();
+
+    updateUnusedPile(board);
+    for (int i = 0; i < STACK_COUNT; i++)
+    {
+        updateStack(board, i);
+    }
+    for (int i = 0; i < FOUNDATION_COUNT; i++)
+    {
+        updateFoundation(board, i);
+    }
+
+    // Foundation columns hold 2 foundations each, so the cursor can always move between them
+    for (int i = 1 + STACK_COUNT; i < COL_COUNT; i++)
+    {
+        this->columns[i].minCursorIndex = 0;
+        this->columns[i].maxCursorIndex = 1;
+        this->columns[i].yHeight = 3;
+    }
+}
+
+// Face down cards of the stacks are shown, the rules stay the same
+void BoardView::setIsThoughtful(bool isThoughtful)
+{
+    this->isThoughtful = isThoughtful;
+}
+
+bool BoardView::getIsThoughtful() const
+{
+    return this->isThoughtful;
+}
+
+const PileView& BoardView::getColumn(int columnIndex) const
+{
+    return this->columns[columnIndex];
+}
+
+const PileView& BoardView::getStack(int stackIndex) const
+{
+    return this->columns[stackIndex + 1];
+}
+
+const PileView& BoardView::getFoundation(int foundationIndex) const
+{
+    return this->foundations[foundationIndex];
+}
+
+bool BoardView::hasNextUnusedCard() const
+{
+    return this->hasNextUnused;
+}
+
+int BoardView::getMoves() const
+{
+    return this->moves;
+}
+
+void BoardView::updateUnusedPile(Board* board)
+{
+    PileView& pile = this->columns[0];
+    Card* currCard = board->getCurrentUnusedCard();
+
+    this->hasNextUnused = board->getNextUnusedCard() != nullptr;
+    pile.hiddenCount = board->getRemainingUnusedCardCount();
+    pile.visibleCount = currCard != nullptr ? 1 : 0;
+    pile.visibleCards[0] = currCard;
+    pile.topCard = currCard;
+
+    if (currCard != nullptr) // 2 rows (X/? + Curr Card)
+    {
+        pile.minCursorIndex = 0;
+        pile.maxCursorIndex = 1;
+        pile.yHeight = 5;
+    }
+    else if (this->hasNextUnused) // 1 row (?)
+    {
+        pile.minCursorIndex = 0;
+        pile.maxCursorIndex = 0;
+        pile.yHeight = 3;
+    }
+    else // 0 rows, empty pile
+    {
+        pile.minCursorIndex = -1;
+        pile.maxCursorIndex = -1;
+        pile.yHeight = EMPTY_PILE_CURSORPIILE_YHEIGHT;
+    }
+}
+
+void BoardView::updateStack(Board* board, int stackIndex)
+{
+    PileView& pile = this->columns[stackIndex + 1];
+    int stackLength = board->getStackLength(stackIndex);
+
+    pile.hiddenCount = board->getHiddenCardCount(stackIndex);
+    pile.visibleCount = 0;
+    pile.topCard = stackLength > 0 ? board->getCardFromStack(stackIndex, stackLength - 1) : nullptr;
+
+    for (int i = 0; i < pile.hiddenCount; i++)
+    {
+        pile.hiddenCards[i] = board->getCardFromStack(stackIndex, i);
+    }
+    for (int i = pile.hiddenCount; i < stackLength && pile.visibleCount < MAX_STACK_LENGTH; i++)
+    {
+        pile.visibleCards[pile.visibleCount++] = board->getCardFromStack(stackIndex, i);
+    }
+
+    // The hidden cards collapse into a single cursor row, even when they are drawn on a row each
+    bool hasHiddenCard = pile.hiddenCount > 0;
+    pile.hiddenRowCount = !hasHiddenCard ? 0 : this->isThoughtful ? pile.hiddenCount : 1;
+    pile.maxCursorIndex = (hasHiddenCard ? 1 : 0) + pile.visibleCount - 1;
+    pile.minCursorIndex = pile.maxCursorIndex == -1 ? -1 : hasHiddenCard ? 1 : 0;
+    pile.yHeight = pile.maxCursorIndex == -1 ? EMPTY_PILE_CURSORPIILE_YHEIGHT : ((hasHiddenCard ? pile.hiddenRowCount + 1 : 0) + pile.visibleCount + 2);
+}
+
+void BoardView::updateFoundation(Board* board, int foundationIndex)
+{
+    PileView& pile = this->foundations[foundationIndex];
+    int foundationLength = board->getFoundationLength(foundationIndex);
+
+    pile.hiddenCount = 0;
+    pile.visibleCount = foundationLength > 0 ? 1 : 0;
+    pile.topCard = foundationLength > 0 ? board->getCardFromFoundation(foundationIndex, foundationLength - 1) : nullptr;
+    pile.visibleCards[0] = pile.topCard;
+}
@@ -0,0 +1,124 @@
+#include "bot.hpp"
+
+#include <cerrno>
+
+#ifdef _WIN32
+    #include <io.h>
+    #include <fcntl.h>
+#else
+    #include <unistd.h>
+#endif
+
+// Raw reads and writes, so a batch is never split or held back by stream buffering
+static int readInput(char* buffer, int length)
+{
+#ifdef _WIN32
+    return _read(0, buffer, length);
+#else
+    return read(STDIN_FILENO, buffer, length);
+#endif
+}
+
+static int writeData(const char* data, int length)
+{
+#ifdef _WIN32
+    return _write(1, data, length);
+#else
+    return write(STDOUT_FILENO, data, length);
+#endif
+}
+
+BotPipe::BotPipe(RuleVariant variant) : session(variant)
+{
+}
+
+int BotPipe::run()
+{
+#ifdef _WIN32
+    // Line breaks stay \n both ways
+    _setmode(0, _O_BINARY);
+    _setmode(1, _O_BINARY);
+#endif
+
+    char buffer[BOT_READ_LENGTH];
+    bool isRunning = true;
+    while (isRunning)
+    {
+        int length = readInput(buffer, sizeof(buffer));
+        if (length < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (length <= 0)
+        {
+            break;
+        }
+
+        this->input.append(buffer, length);
+        size_t lineStart = 0;
+        while (isRunning)
+        {
+            size_t lineEnd = this->input.find('\n', lineStart);
+            if (lineEnd == string::npos)
+            {
+                break;
+            }
+            isRunning = handleLine(this->input.substr(lineStart, lineEnd - lineStart));
+            lineStart = lineEnd + 1;
+        }
+        this->input.erase(0, lineStart);
+
+        if (!writeOutput())
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Returns false on quit
+bool BotPipe::handleLine(const string& line)
+{
+    std::istringstream args(line);
+    string command;
+    string response;
+    args >> command;
+
+    if (command == "quit")
+    {
+        return false;
+    }
+    if (command.empty() || command[0] == '#')
+    {
+        // Blank lines and comments get no response
+        return true;
+    }
+    if (!this->session.handleCommand(command, args, &response))
+    {
+        response = "err unknown command";
+    }
+
+    this->output += response;
+    this->output += '\n';
+    return true;
+}
+
+bool BotPipe::writeOutput()
+{
+    size_t offset = 0;
+    while (offset < this->output.length())
+    {
+        int length = writeData(this->output.data() + offset, this->output.length() - offset);
+        if (length < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (length <= 0)
+        {
+            return false;
+        }
+        offset += length;
+    }
+    this->output.clear();
+    return true;
+}
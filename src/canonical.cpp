@@ -0,0 +1,78 @@
+#include "canonical.hpp"
+
+// Fewer face down cards first, then shorter stacks, then the lower card from the bottom up
+static bool isStackBefore(const Board& board, int a, int b)
+{
+    if (board.getHiddenCardCount(a) != board.getHiddenCardCount(b))
+    {
+        return board.getHiddenCardCount(a) < board.getHiddenCardCount(b);
+    }
+    if (board.getStackLength(a) != board.getStackLength(b))
+    {
+        return board.getStackLength(a) < board.getStackLength(b);
+    }
+    for (int i = 0; i < board.getStackLength(a); i++)
+    {
+        int cardA = getCardId(board.getCardFromStack(a, i));
+        int cardB = getCardId(board.getCardFromStack(b, i));
+        if (cardA != cardB)
+        {
+            return cardA < cardB;
+        }
+    }
+    return false;
+}
+
+void getCanonicalStackOrder(const Board& board, int order[STACK_COUNT])
+{
+    // Insertion sort, there are only 7 stacks
+    for (int i = 0; i < STACK_COUNT; i++)
+    {
+        int j = i;
+        for (; j > 0 && isStackBefore(board, i, order[j - 1]); j--)
+        {
+            order[j] = order[j - 1];
+        }
+        order[j] = i;
+    }
+}
+
+int writeCanonicalKey(const Board& board, uint8_t* key)
+{
+    int order[STACK_COUNT];
+    getCanonicalStackOrder(board, order);
+
+    int length = 0;
+    for (int i = 0; i < STACK_COUNT; i++)
+    {
+        key[length++] = board.getHiddenCardCount(order[i]);
+        for (int j = 0; j < board.getStackLength(order[i]); j++)
+        {
+            key[length++] = getCardId(board.getCardFromStack(order[i], j));
+        }
+        // Card ids are below 52
+        key[length++] = 0xFF;
+    }
+    for (int i = 0; i < FOUNDATION_COUNT; i++)
+    {
+        key[length++] = board.getFoundationLength(i);
+    }
+    key[length++] = board.getWasteLength();
+    key[length++] = board.getRemainingUnusedCardCount();
+    key[length++] = board.getRedealCount();
+    return length;
+}
+
+uint64_t hashCanonicalPosition(const Board& board)
+{
+    uint8_t key[CANONICAL_KEY_LENGTH];
+    int length = writeCanonicalKey(board, key);
+
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for (int i = 0; i < length; i++)
+    {
+        hash = (hash ^ key[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
@@ -1,5 +1,16 @@
 #include "common.hpp"
 
+#define SUIT_CARDS(suit) \
+    { suit, 1 }, { suit, 2 }, { suit, 3 }, { suit, 4 }, { suit, 5 }, { suit, 6 }, { suit, 7 }, \
+    { suit, 8 }, { suit, 9 }, { suit, 10 }, { suit, 11 }, { suit, 12 }, { suit, 13 }
+
+Card DECK[MAX_CARDS] = {
+    SUIT_CARDS(Suit::DIAMONDS),
+    SUIT_CARDS(Suit::CLUBS),
+    SUIT_CARDS(Suit::HEARTS),
+    SUIT_CARDS(Suit::SPADES)
+};
+
 void monoColorPrint(ColorPair colorPair, int y, int startingX, string text)
 {
     int color = static_cast<int>(colorPair);
@@ -1,8 +1,8 @@
 #include "cursor.hpp"
 
-Cursor::Cursor(Board* boardPtr)
+Cursor::Cursor(const BoardView* viewPtr)
 {
-    this->board = boardPtr;
+    this->view = viewPtr;
 
     onNewGame();
 }
@@ -65,7 +65,7 @@ void Cursor::render()
             }
             else
             {
-                yPos = cursorPile.startingY + 2 + cursorPile.currentCursorVerticalIndex;
+                yPos = cursorPile.startingY + 1 + cursorPile.hiddenRowCount + cursorPile.currentCursorVerticalIndex;
             }
         }
         else
@@ -87,68 +87,21 @@ void Cursor::clampCursorPiles()
 {   
     for (int i = 0; i < COL_COUNT; i++)
     {
-        bool isFoundation = i >= 1 + STACK_COUNT;
-        int minVal = -1;
-        int maxVal = 0;
-        int yHeight = 3;
+        const PileView& pile = this->view->getColumn(i);
+        int minVal = pile.minCursorIndex;
+        int maxVal = pile.maxCursorIndex;
 
         this->pileCursors[i].startingY = 2;
 
-        bool hasHiddenCard = false;
-        if (i == 0) // Unused pile
+        if (i == 0) // Unused pile, | X | means no hidden card
         {
-            Card* nextCard = this->board->getNextUnusedCard();
-            hasHiddenCard = nextCard == nullptr; // | X | means no hidden card
-
-            Card* currCard = this->board->getCurrentUnusedCard();
-            if (currCard != nullptr) // 2 rows (X/? + Curr Card)
-            {
-                minVal = 0;
-                maxVal = 1;
-                yHeight = 5;
-            }
-            else if (nextCard != nullptr) // 1 row (?)
-            {
-                minVal = 0;
-                maxVal = 0;
-                yHeight = 3;
-            }
-            else // 0 rows, empty pile
-            {
-                minVal = -1;
-                maxVal = -1;
-                yHeight = EMPTY_PILE_CURSORPIILE_YHEIGHT;
-            }
-        }
-        else if (!isFoundation) // Stacks
-        {
-            int stackIndex = i - 1;
-            int stackLength = this->board->getStackLength(stackIndex);
-            int visibleCount = 0;
-
-            for (int j = 0; j < stackLength; j++)
-            {
-                if (this->board->getCardFromStack(stackIndex, j)->isFaceUp)
-                {
-                    visibleCount++;
-                }
-                else
-                {
-                    hasHiddenCard = true;
-                }
-            }
-            maxVal = (hasHiddenCard ? 1 : 0) + visibleCount - 1;
-            minVal = maxVal == -1 ? -1 : hasHiddenCard ? 1 : 0;
-            yHeight = maxVal == -1 ? EMPTY_PILE_CURSORPIILE_YHEIGHT : ((hasHiddenCard ? 2 : 0) + visibleCount + 2);
+            this->pileCursors[i].hasHiddenCard = !this->view->hasNextUnusedCard();
         }
         else
         {
-            hasHiddenCard = false;
-            minVal = 0;
-            maxVal = 1;
-            yHeight = 3;
+            this->pileCursors[i].hasHiddenCard = pile.hiddenCount > 0 && i <= STACK_COUNT;
         }
-        this->pileCursors[i].hasHiddenCard = hasHiddenCard;
+        this->pileCursors[i].hiddenRowCount = pile.hiddenRowCount;
         // Here we try not to modify it unless it is over the max value, then we shift it back until it is within bounds
         if (this->pileCursors[i].currentCursorVerticalIndex > maxVal)
         {
@@ -158,7 +111,7 @@ void Cursor::clampCursorPiles()
         {
             this->pileCursors[i].currentCursorVerticalIndex = minVal;
         }
-        this->pileCursors[i].yHeight = yHeight;
+        this->pileCursors[i].yHeight = pile.yHeight;
     }
 }
 
@@ -215,4 +168,8 @@ int Cursor::getVerticalCursorIndex()
 int Cursor::getLockedCursorPileIndex()
 {
     return this->lockedCursorPileIndex;
+}
+int Cursor::getLockedVerticalCursorIndex()
+{
+    return this->pileCursors[this->lockedCursorPileIndex].currentCursorVerticalIndex;
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "display.hpp"
-#include "board.hpp"
+#include "boardview.hpp"
+#include "replayviewer.hpp"
 
 Display::Display(Game* game)
 {   
@@ -21,18 +22,21 @@ Display::Display(Game* game)
     int max_y = 0, max_x = 0;
     getmaxyx(stdscr, max_y, max_x);  // Get the size of the window
 
-    if (max_x < MIN_WIDTH || max_y < HEIGHT)
+    this->height = game->getBoardView()->getIsThoughtful() ? THOUGHTFUL_HEIGHT : HEIGHT;
+    if (max_x < MIN_WIDTH || max_y < this->height)
     {
         // quit ncurses and print an error message
         endwin();
         game->setIsRunning(false);
-        std::cout << std::endl << "Please increase the size of your terminal to at least " << MIN_WIDTH << "x" << HEIGHT << "." << std::endl;
+        std::cout << std::endl << "Please increase the size of your terminal to at least " << MIN_WIDTH << "x" << this->height << "." << std::endl;
         return;
     }
 
     this->game = game;
-    this->cursor = new Cursor(this->game->getBoard());
+    this->cursor = new Cursor(this->game->getBoardView());
     this->info = new Info();
+    this->slotBrowser = new SlotBrowser(this->game->getSaveStore());
+    this->replayViewer = new ReplayViewer();
     
     onNewGame();
 }
@@ -45,10 +49,14 @@ Display::~Display()
 
     delete this->cursor;
     delete this->info;
+    delete this->slotBrowser;
+    delete this->replayViewer;
 
     this->game = nullptr;
     this->cursor = nullptr;
     this->info = nullptr;
+    this->slotBrowser = nullptr;
+    this->replayViewer = nullptr;
 }
 
 void Display::onNewGame()
@@ -76,7 +84,15 @@ void Display::render()
         this->info->render();
         break;
     case GameState::PLAYING:
-        drawGameBoard();
+        drawGameBoard(true);
+        break;
+    case GameState::SLOT_BROWSER:
+        this->slotBrowser->render();
+        break;
+    case GameState::REPLAY_VIEWER:
+        // The board view follows the replay, there is nothing to select
+        drawGameBoard(false);
+        this->replayViewer->render(this->height - 1);
         break;
     default:
         break;
@@ -97,6 +113,16 @@ Info* Display::getInfo()
     return this->info;
 }
 
+SlotBrowser* Display::getSlotBrowser()
+{
+    return this->slotBrowser;
+}
+
+ReplayViewer* Display::getReplayViewer()
+{
+    return this->replayViewer;
+}
+
 void Display::setMessage(int messageIndex)
 {
     this->currentMessageIndex = messageIndex;
@@ -117,13 +143,28 @@ bool Display::resetMessage(bool isBackspace)
     return true;
 }
 
+void Display::setHint(const string& hintText)
+{
+    this->hintText = hintText;
+    this->currentMessageIndex = HINT_MSG_INDEX;
+}
+
+// A hint is about the position it was given for, so it goes away once the position changes
+void Display::clearHint()
+{
+    if (this->currentMessageIndex == HINT_MSG_INDEX)
+    {
+        this->currentMessageIndex = 0;
+    }
+}
+
 void Display::drawBoundary()
 {
-    for (int y = 0; y < HEIGHT - 1; y++)
+    for (int y = 0; y < this->height - 1; y++)
     {
         for (int x = 0; x < MIN_WIDTH; x++)
         {
-            if (y == 0 || y == HEIGHT - 2 || x == 0 || x == MIN_WIDTH - 1)
+            if (y == 0 || y == this->height - 2 || x == 0 || x == MIN_WIDTH - 1)
             {
                 monoColorPrint(ColorPair::GREEN, y, x, "#");  // Print # at the boundary
             }
@@ -132,7 +173,7 @@ void Display::drawBoundary()
 }
 
 void Display::drawMenu(bool isGameMenu) {
-    int start_y = (HEIGHT - 10) / 2;  // Calculate the starting y position
+    int start_y = (this->height - 10) / 2;  // Calculate the starting y position
     int start_x = (MIN_WIDTH - 27) / 2;  // Calculate the starting x position
     
     // Create formatting text arrays
@@ -168,7 +209,7 @@ void Display::drawMenu(bool isGameMenu) {
 }
 
 // Reference docs/game_design.txt for design
-void Display::drawGameBoard()
+void Display::drawGameBoard(bool hasCursor)
 {
     drawVerticalDelimiter(9);
     drawVerticalDelimiter(59);
@@ -183,12 +224,15 @@ void Display::drawGameBoard()
         drawFoundation(static_cast<Suit>(i));
     }
 
-    this->cursor->render();
+    if (hasCursor)
+    {
+        this->cursor->render();
+    }
 }
 
 void Display::drawVerticalDelimiter(int x)
 {
-    for (int i = 1; i < HEIGHT - 2; i++)
+    for (int i = 1; i < this->height - 2; i++)
     {
         monoColorPrint(ColorPair::GREEN, i, x, "|");
     }
@@ -199,19 +243,20 @@ void Display::drawUnusedPile()
     int start_x = HORIZ_CURSOR_XPOS[0] + 1;
     int y = 2;
 
-    int hiddenCount = this->game->getBoard()->getRemainingUnusedCardCount();
-    Card* currCard = this->game->getBoard()->getCurrentUnusedCard();
+    const BoardView* view = this->game->getBoardView();
+    const PileView& pile = view->getColumn(0);
+    int hiddenCount = pile.hiddenCount;
+    Card* currCard = pile.topCard;
     if (currCard == nullptr)
     {
         if (hiddenCount > 0)
         {
-            drawCard(start_x, y, hiddenCount, 0, nullptr);
+            drawCard(start_x, y, hiddenCount, nullptr, 0, nullptr);
         }
     }
     else
     {
-        Card* nextCard = this->game->getBoard()->getNextUnusedCard();
-        if (nextCard == nullptr)
+        if (!view->hasNextUnusedCard())
         {   
             ColorRange range1[3] = { { ColorPair::GREEN, 2 }, { ColorPair::CYAN, 3}, { ColorPair::GREEN, 5} };
 
@@ -232,47 +277,33 @@ void Display::drawUnusedPile()
         }
         else
         {
-            Card* visibleCards[1] { currCard };
-            y = drawCard(start_x, y++, hiddenCount, 1, visibleCards);
+            y = drawCard(start_x, y++, hiddenCount, nullptr, 1, pile.visibleCards);
         }
     }
 }
 
 void Display::drawStack(int stackIndex)
 {
-    int stackLength = this->game->getBoard()->getStackLength(stackIndex);
-    if (stackLength == 0)
+    const PileView& pile = this->game->getBoardView()->getStack(stackIndex);
+    if (pile.topCard == nullptr)
     {
         return;
     }
 
-    int hiddenCount = 0;
-    int visibleCount = 0;
     int start_x = HORIZ_CURSOR_XPOS[1] + 1 + COL_WIDTH * stackIndex;
     int start_y = 2;
 
-    Card* stack[stackLength];
-
-    for (int i = 0; i < stackLength; i++)
-    {
-        stack[i] = this->game->getBoard()->getCardFromStack(stackIndex, i);
-        stack[i]->isFaceUp ? visibleCount++ : hiddenCount++;
-    }
-    Card* visibleStack[visibleCount];
-    for (int i = 0; i < visibleCount; i++)
-    {
-        visibleStack[i] = stack[i + hiddenCount];
-    }
-    drawCard(start_x, start_y, hiddenCount, visibleCount, visibleStack);
+    bool isThoughtful = this->game->getBoardView()->getIsThoughtful();
+    drawCard(start_x, start_y, pile.hiddenCount, isThoughtful ? pile.hiddenCards : nullptr, pile.visibleCount, pile.visibleCards);
 }
 
 void Display::drawFoundation(Suit suitIndex)
 {
-    int foundationLength = this->game->getBoard()->getFoundationLength(suitIndex);
+    const PileView& pile = this->game->getBoardView()->getFoundation(suitIndex);
     int start_x = HORIZ_CURSOR_XPOS[8] + 1 + COL_WIDTH * (suitIndex % 2);
     int start_y = 2 + 4 * (suitIndex / 2);
 
-    if (foundationLength == 0)
+    if (pile.topCard == nullptr)
     {   
         string textParam[1] = { getSuitChar(suitIndex).c_str() };
         ColorRange range[3] = { { ColorPair::GREEN, 1 }, { isRed(suitIndex) ? ColorPair::RED : ColorPair::WHITE, 3 }, { ColorPair::GREEN, 5 } }; 
@@ -283,22 +314,18 @@ void Display::drawFoundation(Suit suitIndex)
     }
     else
     {
-        // Make a 1-element array to pass to draw-card
-        Card* foundationCard = foundationLength == 0 ? nullptr : this->game->getBoard()->getCardFromFoundation(suitIndex, foundationLength - 1);
-        Card* foundationCardArray[1] { foundationCard };
-
-        drawCard(start_x, start_y, 0, foundationLength >= 1 ? 1 : 0, foundationCardArray);
+        drawCard(start_x, start_y, 0, nullptr, pile.visibleCount, pile.visibleCards);
     }
 }
 
 void Display::drawMessage(bool drawMoves)
 {
-    int y = HEIGHT - 1;
+    int y = this->height - 1;
     
     if (drawMoves)
     {    
         // Draw moves at x = 62
-        int moves = this->game->getBoard()->getMoves();
+        int moves = this->game->getBoardView()->getMoves();
         string message = "Moves: " + std::to_string(moves);
         monoColorPrint(ColorPair::MAGENTA, y, MOVE_MSG_STARTING_X, message);
     }
@@ -320,20 +347,37 @@ void Display::drawMessage(bool drawMoves)
     {
         monoColorPrint(this->currentMessageIndex <  LOAD_SAVE_MSG_INDEX + 2 ? ColorPair::RED : ColorPair::GREEN, y, MSG_STARTING_X, string(MESSAGES[this->currentMessageIndex]) + string(MESSAGES[2]));
     }
+    else if (this->currentMessageIndex == HINT_MSG_INDEX)
+    {
+        monoColorPrint(ColorPair::CYAN, y, MSG_STARTING_X, string(MESSAGES[HINT_MSG_INDEX]) + this->hintText);
+    }
     else // Errors
     {
         monoColorPrint(ColorPair::RED, y, MSG_STARTING_X, string(MESSAGES[ERROR_MSG_INDEX]) + string(MESSAGES[2]));
     }
 }
 
-int Display::drawCard(int start_x, int start_y, int hiddenCount, int visibleCount, Card* cards[])
+// hiddenCards is nullptr unless the face down cards are shown, they are then drawn on a row each with a cyan border
+int Display::drawCard(int start_x, int start_y, int hiddenCount, Card* const hiddenCards[], int visibleCount, Card* const cards[])
 {   
     int current_y = start_y;
     drawCardDivider(start_x, current_y++, true);
 
     // Draw the hidden cards
     string hiddenText = "";
-    if (hiddenCount > 0)
+    if (hiddenCount > 0 && hiddenCards != nullptr)
+    {
+        for (int i = 0; i < hiddenCount; i++)
+        {
+            Card* card = hiddenCards[i];
+            string textParam[2] = { (getValueChar(card->value) + (card->value == 10 ? "" : " ")).c_str(), getSuitChar(card->suit).c_str() };
+            ColorRange colorRange[3] = { { ColorPair::CYAN, 1 }, { isRed(card->suit) ? ColorPair::RED : ColorPair::WHITE, 4 }, { ColorPair::CYAN, 5 } };
+
+            multiColorPrint(current_y++, start_x, formatString("|~~|", 2, textParam), 3, colorRange);
+        }
+        drawCardDivider(start_x, current_y++, visibleCount <= 0);
+    }
+    else if (hiddenCount > 0)
     {
         if (hiddenCount == 1)
         {
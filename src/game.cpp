@@ -2,89 +2,215 @@
 #include "board.hpp"
 #include "display.hpp"
 #include "logic.hpp"
-
-Game::Game()
+#include "autosave.hpp"
+#include "saveworker.hpp"
+#include "savestore.hpp"
+#include "archive.hpp"
+#include "replayviewer.hpp"
+#include "analysis.hpp"
+#include "replay.hpp"
+
+// Thoughtful mode shows the face down cards, the display is sized for it as it starts
+Game::Game(bool isThoughtful)
 {   
     // Initialize the game loop
     this->isRunning = true;
-    srand(time(0));
+    this->seedGenerator.seed(static_cast<uint32_t>(time(0)));
 
     this->gameState = GameState::MAIN_MENU;
     this->menuOption = MenuOption::NEW_GAME;
 
+    this->saveStore = new SaveStore();
+
     this->board = new Board();
+    this->history = new MoveHistory();
+    this->boardView.setIsThoughtful(isThoughtful);
     this->display = new Display(this);
-    this->logic = new Logic(this->board, this->display);
-    this->persistence = new Persistence(this->board, this->deck);
+    this->logic = new Logic(this->board, this->display, &this->boardView, this->history);
+    this->persistence = new Persistence(this->board, this->history);
+    this->saveWorker = new SaveWorker(this->persistence);
+    this->analysisWorker = new AnalysisWorker();
+    this->ruleVariant = RuleVariant::STANDARD_RULES;
+    this->analysedMoves = -1;
+    this->isHintPending = false;
 
-    this->isGamePreviouslyCreated = false;
     this->hasAlreadyWon = false;
+    // No game to archive yet
+    this->hasArchivedGame = true;
 }
 
 Game::~Game()
 {
-    cleanUp(true);
+    cleanUp();
 }
 
 void Game::createGame(bool fromLoad)
 {   
-    // Reset the game
-    if (this->isGamePreviouslyCreated)
-    {
-        cleanUp(false);
-    }
-    else
-    {
-        this->isGamePreviouslyCreated = true;
-    }
-
+    // Reset the game, every piece of storage is reused so this never allocates
     this->gameState = GameState::PLAYING;
     this->hasAlreadyWon = false;
     this->hasAlreadyPromptedAutoFinished = false;
 
+    // Commit what is left of the previous game before the board is reset
+    archiveGame(GameResult::ABANDONED);
+    if (this->autosave != nullptr)
+    {
+        this->autosave->stop();
+    }
+
     this->display->onNewGame();
     this->board->onNewGame();
-
-    createCards();
+    this->hasArchivedGame = false;
+    this->startTime = std::chrono::steady_clock::now();
+    this->history->clear();
+    this->analysisWorker->cancel();
+    this->analysedMoves = -1;
+    this->isHintPending = false;
 
     if (!fromLoad)
     {
-        shuffleCards();
-        board->distributeCards(this->deck);
+        // 0 marks an unknown seed
+        uint32_t seed;
+        do
+        {
+            seed = this->seedGenerator();
+        }
+        while (seed == 0);
+        // A loaded game may have had other rules
+        this->board->setRuleVariant(this->ruleVariant);
+        this->board->dealCards(seed);
+
+        if (this->autosave != nullptr)
+        {
+            this->autosave->onNewGame();
+        }
     }
 }
 
-void Game::finishGame()
+// Record every finished or abandoned game in the archive
+void Game::enableArchive()
 {
-    // Clean up every stack
-    for (int i = 0; i < STACK_COUNT; i++)
+    if (this->archive != nullptr)
     {
-        int stackLength = this->board->getStackLength(i);
-        for (int j = 0; j < stackLength; j++)
-        {
-            Card* card = this->board->removeCardFromStack(i);
-            if (card->value == MAX_VALUE)
-            {
-                this->board->addCardToFoundation(card->suit, card);
-            }
-        }
+        return;
+    }
+    this->archive = new ArchiveWriter();
+    if (!this->archive->open(ARCHIVE_NAME))
+    {
+        delete this->archive;
+        this->archive = nullptr;
+    }
+}
+
+// Autosave every move, and resume the game that was autosaved last if there is one
+void Game::enableAutosave()
+{
+    if (this->autosave != nullptr)
+    {
+        return;
+    }
+    this->autosave = new Autosave(this->history, this->persistence, this->logic);
+
+    createGame(true);
+    if (this->autosave->recover())
+    {
+        this->display->setMessage(LOAD_SAVE_MSG_INDEX + 3);
+    }
+    else
+    {
+        this->gameState = GameState::MAIN_MENU;
     }
+}
+
+// Rules of every new game from now on, a loaded game keeps the rules it was saved with
+void Game::setRuleVariant(RuleVariant variant)
+{
+    this->ruleVariant = variant;
+    this->board->setRuleVariant(variant);
+}
+
+// Shows a game in the replay viewer, Backspace leaves it for the main menu
+void Game::startReplayViewer(uint32_t seed, RuleVariant variant, const Move* moves, int moveCount)
+{
+    this->display->getReplayViewer()->load(seed, variant, moves, moveCount);
+    this->gameState = GameState::REPLAY_VIEWER;
+}
+
+void Game::finishGame()
+{
+    // Every remaining move is a real move, so the game can still be replayed from its journal
+    this->logic->autoFinish();
 
     this->hasAlreadyWon = true;
     this->display->setMessage(1);
+    archiveGame(GameResult::WON);
+    if (this->autosave != nullptr)
+    {
+        this->autosave->discard();
+    }
 }
 
 void Game::update()
 {
+    // Report a save that finished in the background
+    bool isSaved;
+    if (this->saveWorker->pollResult(&isSaved))
+    {
+        flash();
+        this->display->setMessage(LOAD_SAVE_MSG_INDEX + (isSaved ? 2 : 0));
+    }
+
+    // Journal the moves of the last input
+    if (this->autosave != nullptr)
+    {
+        this->autosave->update();
+    }
+
+    // Play the replay moves that are due
+    ReplayViewer* replayViewer = this->display->getReplayViewer();
+    if (this->gameState == GameState::REPLAY_VIEWER)
+    {
+        replayViewer->update();
+        this->boardView.update(replayViewer->getBoard());
+    }
+
+    // Wake up in time to commit the journal, report a save or play the next replay move, even if no more input comes
+    int inputDelay = this->autosave != nullptr ? this->autosave->getCommitDelay() : -1;
+    if (this->saveWorker->getIsBusy() && (inputDelay < 0 || inputDelay > SAVE_POLL_INTERVAL_MS))
+    {
+        inputDelay = SAVE_POLL_INTERVAL_MS;
+    }
+    if (this->isHintPending && (inputDelay < 0 || inputDelay > ANALYSIS_POLL_INTERVAL_MS))
+    {
+        inputDelay = ANALYSIS_POLL_INTERVAL_MS;
+    }
+    int stepDelay = this->gameState == GameState::REPLAY_VIEWER ? replayViewer->getStepDelay() : -1;
+    if (stepDelay >= 0 && (inputDelay < 0 || inputDelay > stepDelay))
+    {
+        inputDelay = stepDelay;
+    }
+    timeout(inputDelay);
+
     // Update the game
     if (this->gameState != GameState::PLAYING)
     {
         return;
     }
 
-    this->board->flipTopStackCards();
+    this->boardView.update(this->board);
     this->display->getCursor()->clampCursorPiles();
 
+    // Start on the hint of a new position right away, and show a hint that was waiting for it
+    if (this->board->getMoves() != this->analysedMoves && !this->logic->isGameWon())
+    {
+        this->analysisWorker->requestAnalysis(*this->board, this->board->getRuleVariant());
+        this->analysedMoves = this->board->getMoves();
+    }
+    if (this->isHintPending)
+    {
+        showHint();
+    }
+
     // Logic checks
     if (this->logic->isGameWon())
     {
@@ -94,6 +220,11 @@ void Game::update()
         }
         this->display->setMessage(1);
         this->hasAlreadyWon = true;
+        archiveGame(GameResult::WON);
+        if (this->autosave != nullptr)
+        {
+            this->autosave->discard();
+        }
     }
     else if (this->logic->canAutoFinish())
     {
@@ -135,6 +266,14 @@ void Game::handleInput()
             // Regress to the previous menu
             this->gameState = this->display->getInfo()->getPrevMenuState();
         }
+        else if (this->gameState == GameState::SLOT_BROWSER)
+        {
+            this->gameState = this->display->getSlotBrowser()->getPrevMenuState();
+        }
+        else if (this->gameState == GameState::REPLAY_VIEWER)
+        {
+            this->gameState = GameState::MAIN_MENU;
+        }
         else if (this->gameState == GameState::PLAYING)
         {
             this->gameState = this->hasAlreadyWon ? GameState::MAIN_MENU : GameState::GAME_MENU;
@@ -165,6 +304,14 @@ void Game::handleInput()
     {
         handleArrowKeys(static_cast<ArrowKey>(ch));
     }
+    else if (this->gameState == GameState::REPLAY_VIEWER)
+    {
+        handleReplayKey(ch);
+    }
+    else if (this->gameState == GameState::PLAYING && (ch == 'h' || ch == 'H'))
+    {
+        handleHintKey();
+    }
 }
 
 bool Game::getIsRunning()
@@ -197,67 +344,55 @@ Board* Game::getBoard()
     return this->board;
 }
 
+SaveStore* Game::getSaveStore()
+{
+    return this->saveStore;
+}
+
+const BoardView* Game::getBoardView()
+{
+    return &this->boardView;
+}
+
 void Game::setIsRunning(bool isRunning)
 {
     this->isRunning = isRunning;
 }
 
-void Game::cleanUp(bool hardCleanUp) // If hardCleanUp is true, delete all objects
+void Game::cleanUp()
 {
-    // Clean up the game
-    deleteCards();
+    // Clean up the game, pending saves and autosaved moves are written first
+    archiveGame(GameResult::ABANDONED);
+    delete this->archive;
+    this->archive = nullptr;
 
-    if (hardCleanUp)
-    {
-        delete this->display;
-        this->display = nullptr;
+    delete this->saveWorker;
+    this->saveWorker = nullptr;
 
-        delete this->display;
-        this->display = nullptr;
+    delete this->analysisWorker;
+    this->analysisWorker = nullptr;
 
-        delete this->logic;
-        this->logic = nullptr;
+    delete this->autosave;
+    this->autosave = nullptr;
 
-        delete this->persistence;
-        this->persistence = nullptr;
-    }
-    else
-    {
-        this->board->cleanup();
-    }
-}
+    delete this->display;
+    this->display = nullptr;
 
-void Game::createCards()
-{
-    // Create 52 cards
-    for (int i = 0; i < 52; ++i) {
-        this->deck[i] = new Card{ static_cast<Suit>(i / 13), i % 13 + 1} ;
-    }
-}
+    delete this->logic;
+    this->logic = nullptr;
 
-void Game::deleteCards()
-{
-    // Delete all card objects
-    for (int i = 0; i < 52; ++i) {
-        if (this->deck[i] != nullptr)
-        {
-            delete this->deck[i];
-            this->deck[i] = nullptr;
-        }
-    }
-}
+    delete this->persistence;
+    this->persistence = nullptr;
 
-void Game::shuffleCards()
-{
-    // Shuffle the deck using the Fisher-Yates algorithm
-    for (int i = 51; i > 0; --i) {
-        int j = rand() % (i + 1);
-        Card* temp = this->deck[i];
-        this->deck[i] = this->deck[j];
-        this->deck[j] = temp;
-    }
-}
+    delete this->board;
+    this->board = nullptr;
+
+    delete this->saveStore;
+    this->saveStore = nullptr;
 
+    delete this->history;
+    this->history = nullptr;
+}
 
 void Game::handleArrowKeys(ArrowKey arrowKey)
 {
@@ -274,6 +409,12 @@ void Game::handleArrowKeys(ArrowKey arrowKey)
         case GameState::INFO_PAGE:
             this->display->getInfo()->shiftRow(false);
             break;
+        case GameState::SLOT_BROWSER:
+            this->display->getSlotBrowser()->shiftRow(false);
+            break;
+        case GameState::REPLAY_VIEWER:
+            this->display->getReplayViewer()->seekPage(false);
+            break;
         default:
             if (this->menuOption > MenuOption::NEW_GAME)
             {
@@ -291,6 +432,12 @@ void Game::handleArrowKeys(ArrowKey arrowKey)
         case GameState::INFO_PAGE:
             this->display->getInfo()->shiftRow(true);
             break;
+        case GameState::SLOT_BROWSER:
+            this->display->getSlotBrowser()->shiftRow(true);
+            break;
+        case GameState::REPLAY_VIEWER:
+            this->display->getReplayViewer()->seekPage(true);
+            break;
         default:
             if (this->menuOption < MenuOption::QUIT)
             {
@@ -303,12 +450,81 @@ void Game::handleArrowKeys(ArrowKey arrowKey)
         {
             this->display->getCursor()->updateHorizCursorX(true);
         }
+        else if (this->gameState == GameState::SLOT_BROWSER)
+        {
+            this->display->getSlotBrowser()->shiftPage(true);
+        }
+        else if (this->gameState == GameState::REPLAY_VIEWER)
+        {
+            this->display->getReplayViewer()->step(true);
+        }
         break;
     case ArrowKey::LEFT:
         if (this->gameState == GameState::PLAYING)
         {
             this->display->getCursor()->updateHorizCursorX(false);
         }
+        else if (this->gameState == GameState::SLOT_BROWSER)
+        {
+            this->display->getSlotBrowser()->shiftPage(false);
+        }
+        else if (this->gameState == GameState::REPLAY_VIEWER)
+        {
+            this->display->getReplayViewer()->step(false);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+// Shows the hint right away if the analysis is done, otherwise once it is
+void Game::handleHintKey()
+{
+    if (this->logic->isGameWon())
+    {
+        return;
+    }
+
+    this->isHintPending = true;
+    showHint();
+    if (this->isHintPending)
+    {
+        this->display->setHint("Thinking...");
+    }
+}
+
+void Game::showHint()
+{
+    Move move;
+    bool hasMove;
+    if (!this->analysisWorker->pollHint(&move, &hasMove))
+    {
+        return;
+    }
+
+    this->isHintPending = false;
+    this->display->setHint(hasMove ? describeMove(move) : "No moves left");
+}
+
+// Keys of the replay viewer besides the arrows and Enter
+void Game::handleReplayKey(int ch)
+{
+    ReplayViewer* replayViewer = this->display->getReplayViewer();
+    switch (ch)
+    {
+    case '+':
+    case '=':
+        replayViewer->shiftSpeed(true);
+        break;
+    case '-':
+        replayViewer->shiftSpeed(false);
+        break;
+    case KEY_HOME:
+        replayViewer->seekEnd(false);
+        break;
+    case KEY_END:
+        replayViewer->seekEnd(true);
         break;
     default:
         break;
@@ -323,8 +539,6 @@ void Game::handleEnterKey()
     }
     if (this->gameState <= GameState::GAME_MENU)
     {
-        int result = 0;
-
         switch (this->menuOption)
         {
         case MenuOption::NEW_GAME:
@@ -339,27 +553,11 @@ void Game::handleEnterKey()
             break;
 
         case MenuOption::LOAD_SAVE_GAME:
-            if (this->gameState == GameState::GAME_MENU)
-            {
-                // Save game
-                result = this->persistence->saveFile() ? 3 : 1;
-            }
-            else // Load game
-            {
-                createGame(true);
-                result = this->persistence->loadFile() ? 4 : 2;
-
-                if (result == 2) // Load failed
-                {
-                    this->gameState = GameState::MAIN_MENU;
-                }
-            }
-
-            if (result >= 1)
-            {
-                flash();
-                this->display->setMessage(LOAD_SAVE_MSG_INDEX + result - 1);
-            }
+            // Pick a slot first, saving or loading depends on the menu we came from
+            // The store is only created once there is something to save
+            this->saveStore->open(this->gameState == GameState::GAME_MENU);
+            this->display->getSlotBrowser()->setPrevMenuState(this->gameState);
+            this->gameState = GameState::SLOT_BROWSER;
             break;
 
         case MenuOption::INFO:
@@ -374,19 +572,30 @@ void Game::handleEnterKey()
             }
             else // Stop Game
             {
+                archiveGame(GameResult::ABANDONED);
                 this->gameState = GameState::MAIN_MENU;
             }
             break;
         }
     }
-    else
+    else if (this->gameState == GameState::SLOT_BROWSER)
+    {
+        handleSlotSelection();
+    }
+    else if (this->gameState == GameState::REPLAY_VIEWER)
+    {
+        this->display->getReplayViewer()->togglePlaying();
+    }
+    else if (this->gameState == GameState::PLAYING)
     {
         // Usually confirming an action.
         int horizCursorXIndex = this->display->getCursor()->getHorizCursorXIndex();
         int verticalCursorIndex = this->display->getCursor()->getVerticalCursorIndex();
+        int lockedCursorPileIndex = this->display->getCursor()->getLockedCursorPileIndex();
         bool result;
 
-        if (verticalCursorIndex == -1) // Empty pile should not have any inputs
+        // Selecting an empty pile should not have any inputs, but it can still receive cards (e.g. a King)
+        if (verticalCursorIndex == -1 && horizCursorXIndex == lockedCursorPileIndex)
         {
             result = false;
         }
@@ -398,12 +607,21 @@ void Game::handleEnterKey()
         else if (horizCursorXIndex >= 1 && horizCursorXIndex <= STACK_COUNT)
         {
             // Stack
-            result = this->logic->handleStackSelection(horizCursorXIndex - 1, this->display->getCursor()->getLockedCursorPileIndex(), verticalCursorIndex);
+            // The card to move is picked by the vertical cursor of the locked pile
+            result = this->logic->handleStackSelection(horizCursorXIndex - 1, lockedCursorPileIndex, this->display->getCursor()->getLockedVerticalCursorIndex());
         }
         else
         {
             // Foundation
-            result = this->logic->handleFoundationSelection(this->display->getCursor()->getLockedCursorPileIndex(), verticalCursorIndex);
+            result = this->logic->handleFoundationSelection(lockedCursorPileIndex, verticalCursorIndex);
+        }
+
+        // The analysis of the old position is stale now, it stops before the next frame is drawn
+        if (this->board->getMoves() != this->analysedMoves)
+        {
+            this->analysisWorker->cancel();
+            this->isHintPending = false;
+            this->display->clearHint();
         }
 
         // Flash the screen if there was an error
@@ -414,4 +632,65 @@ void Game::handleEnterKey()
             this->display->setMessage(ERROR_MSG_INDEX);
         }
     }
+}
+
+void Game::handleSlotSelection()
+{
+    int slotRowIndex = this->display->getSlotBrowser()->getSelectedRow();
+    int result;
+
+    if (this->display->getSlotBrowser()->getPrevMenuState() == GameState::GAME_MENU) // Save game
+    {
+        this->gameState = GameState::GAME_MENU;
+        if (slotRowIndex == 0)
+        {
+            // Save file in the background, the result is reported by update
+            this->saveWorker->requestSave(SAVEFILE_NAME, nullptr);
+            return;
+        }
+        result = this->saveStore->saveSlot(slotRowIndex - 1, *this->board) ? 3 : 1;
+    }
+    else // Load game
+    {
+        // Load what was saved last, even if it is still being written
+        this->saveWorker->wait();
+        createGame(true);
+        if (slotRowIndex == 0)
+        {
+            result = this->persistence->loadFile() ? 4 : 2;
+        }
+        else
+        {
+            result = this->saveStore->loadSlot(slotRowIndex - 1, this->board) ? 4 : 2;
+        }
+
+        if (result == 2) // Load failed
+        {
+            this->gameState = GameState::MAIN_MENU;
+        }
+        else if (this->autosave != nullptr)
+        {
+            this->autosave->onNewGame();
+        }
+    }
+
+    flash();
+    this->display->setMessage(LOAD_SAVE_MSG_INDEX + result - 1);
+}
+
+// Games that were never moved in are not archived
+void Game::archiveGame(GameResult result)
+{
+    if (this->archive == nullptr || this->hasArchivedGame || (result != GameResult::WON && this->board->getMoves() == 0))
+    {
+        return;
+    }
+
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - this->startTime);
+    GameRecord record = { this->board->getSeed(), result, static_cast<uint32_t>(this->board->getMoves()), static_cast<uint32_t>(duration.count()),
+        this->board->getRuleVariant(), this->history };
+    // Flushed right away so a crash loses no finished game, the block is still only ended once it is full
+    this->archive->append(record);
+    this->archive->flush();
+    this->hasArchivedGame = true;
 }
\ No newline at end of file
@@ -0,0 +1,282 @@
+#include "gamecodec.hpp"
+
+// Carryless range coder (Subbotin), 32 bit low and range
+constexpr uint32_t RANGE_TOP = 1u << 24;
+constexpr uint32_t RANGE_BOTTOM = 1u << 16;
+
+class RangeEncoder
+{
+public:
+    RangeEncoder(vector<char>* data)
+    {
+        this->data = data;
+        this->low = 0;
+        this->range = 0xFFFFFFFF;
+    }
+
+    void encode(uint32_t cumulativeFrequency, uint32_t frequency, uint32_t totalFrequency)
+    {
+        this->range /= totalFrequency;
+        this->low += cumulativeFrequency * this->range;
+        this->range *= frequency;
+        while ((this->low ^ (this->low + this->range)) < RANGE_TOP ||
+            (this->range < RANGE_BOTTOM && ((this->range = -this->low & (RANGE_BOTTOM - 1)), true)))
+        {
+            this->data->push_back(static_cast<char>(this->low >> 24));
+            this->low <<= 8;
+            this->range <<= 8;
+        }
+    }
+
+    void flush()
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            this->data->push_back(static_cast<char>(this->low >> 24));
+            this->low <<= 8;
+        }
+    }
+
+private:
+    vector<char>* data;
+    uint32_t low;
+    uint32_t range;
+};
+
+class RangeDecoder
+{
+public:
+    RangeDecoder(const char* data, int dataLength)
+    {
+        this->data = data;
+        this->dataLength = dataLength;
+        this->dataIndex = 0;
+        this->low = 0;
+        this->range = 0xFFFFFFFF;
+        this->code = 0;
+        this->isPastEnd = false;
+        for (int i = 0; i < 4; i++)
+        {
+            this->code = (this->code << 8) | readByte();
+        }
+    }
+
+    // Must be followed by decode with the frequency range the result falls in
+    uint32_t getFrequency(uint32_t totalFrequency)
+    {
+        this->range /= totalFrequency;
+        uint32_t frequency = (this->code - this->low) / this->range;
+        return frequency < totalFrequency ? frequency : totalFrequency - 1;
+    }
+
+    void decode(uint32_t cumulativeFrequency, uint32_t frequency)
+    {
+        this->low += cumulativeFrequency * this->range;
+        this->range *= frequency;
+        while ((this->low ^ (this->low + this->range)) < RANGE_TOP ||
+            (this->range < RANGE_BOTTOM && ((this->range = -this->low & (RANGE_BOTTOM - 1)), true)))
+        {
+            this->code = (this->code << 8) | readByte();
+            this->low <<= 8;
+            this->range <<= 8;
+        }
+    }
+
+    // The encoder's flush writes every byte the decoder reads, so reading past the end means the data is corrupt
+    bool hasReadPastEnd()
+    {
+        return this->isPastEnd;
+    }
+
+private:
+    const char* data;
+    int dataLength;
+    int dataIndex;
+    uint32_t low;
+    uint32_t range;
+    uint32_t code;
+    bool isPastEnd;
+
+    uint32_t readByte()
+    {
+        if (this->dataIndex >= this->dataLength)
+        {
+            this->isPastEnd = true;
+            return 0;
+        }
+        return static_cast<unsigned char>(this->data[this->dataIndex++]);
+    }
+};
+
+GameCodec::GameCodec()
+{
+    resetModel();
+}
+
+// Fails if a move is not legal in its position, or there are more than CODEC_MAX_MOVE_COUNT moves
+bool GameCodec::encode(uint32_t seed, RuleVariant variant, const Move* moves, int moveCount, vector<char>* data)
+{
+    data->clear();
+    if (moveCount < 0 || static_cast<uint32_t>(moveCount) > CODEC_MAX_MOVE_COUNT)
+    {
+        return false;
+    }
+    for (uint32_t count = moveCount; ; count >>= 7)
+    {
+        if (count < 0x80)
+        {
+            data->push_back(static_cast<char>(count));
+            break;
+        }
+        data->push_back(static_cast<char>(0x80 | (count & 0x7F)));
+    }
+
+    resetModel();
+    this->replay.deal(seed, variant);
+    RangeEncoder encoder(data);
+    Move legalMoves[MAX_MOVES];
+    for (int i = 0; i < moveCount; i++)
+    {
+        int legalMoveCount = this->replay.generateMoves(legalMoves);
+        int moveIndex = 0;
+        while (moveIndex < legalMoveCount && !(legalMoves[moveIndex] == moves[i]))
+        {
+            moveIndex++;
+        }
+        if (moveIndex == legalMoveCount || !this->replay.applyMove(moves[i]))
+        {
+            return false;
+        }
+
+        if (legalMoveCount > 1)
+        {
+            int context = getContext(legalMoveCount);
+            int symbol = (moveIndex + 1) % legalMoveCount;
+            encoder.encode(getCumulativeFrequency(context, symbol), this->frequencies[context][symbol], getTotalFrequency(context, legalMoveCount));
+            updateModel(context, symbol);
+        }
+    }
+    encoder.flush();
+    return true;
+}
+
+// Fails on a move count above CODEC_MAX_MOVE_COUNT, or data that ends before the last move
+bool GameCodec::decode(uint32_t seed, RuleVariant variant, const char* data, int dataLength, vector<Move>* moves)
+{
+    moves->clear();
+    uint32_t moveCount = 0;
+    int dataIndex = 0;
+    for (int shift = 0; ; shift += 7)
+    {
+        if (dataIndex >= dataLength || shift > 28)
+        {
+            return false;
+        }
+        unsigned char byte = static_cast<unsigned char>(data[dataIndex++]);
+        moveCount |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if (byte < 0x80)
+        {
+            break;
+        }
+    }
+    if (moveCount > CODEC_MAX_MOVE_COUNT)
+    {
+        return false;
+    }
+
+    resetModel();
+    this->replay.deal(seed, variant);
+    RangeDecoder decoder(data + dataIndex, dataLength - dataIndex);
+    Move legalMoves[MAX_MOVES];
+    for (uint32_t i = 0; i < moveCount; i++)
+    {
+        int legalMoveCount = this->replay.generateMoves(legalMoves);
+        if (legalMoveCount == 0)
+        {
+            return false;
+        }
+
+        int moveIndex = 0;
+        if (legalMoveCount > 1)
+        {
+            int context = getContext(legalMoveCount);
+            uint32_t frequency = decoder.getFrequency(getTotalFrequency(context, legalMoveCount));
+            int symbol = 0;
+            uint32_t cumulativeFrequency = 0;
+            while (cumulativeFrequency + this->frequencies[context][symbol] <= frequency)
+            {
+                cumulativeFrequency += this->frequencies[context][symbol];
+                symbol++;
+            }
+            decoder.decode(cumulativeFrequency, this->frequencies[context][symbol]);
+            if (decoder.hasReadPastEnd())
+            {
+                return false;
+            }
+            updateModel(context, symbol);
+            moveIndex = (symbol + legalMoveCount - 1) % legalMoveCount;
+        }
+
+        moves->push_back(legalMoves[moveIndex]);
+        this->replay.applyMove(legalMoves[moveIndex]);
+    }
+    return !decoder.hasReadPastEnd();
+}
+
+const Board* GameCodec::getBoard()
+{
+    return this->replay.getBoard();
+}
+
+bool GameCodec::isGameWon()
+{
+    return this->replay.isGameWon();
+}
+
+void GameCodec::resetModel()
+{
+    for (int i = 0; i < CODEC_CONTEXT_COUNT; i++)
+    {
+        for (int j = 0; j < MAX_MOVES; j++)
+        {
+            this->frequencies[i][j] = 1;
+        }
+        this->totals[i] = MAX_MOVES;
+    }
+}
+
+int GameCodec::getContext(int legalMoveCount)
+{
+    return (legalMoveCount < CODEC_CONTEXT_COUNT ? legalMoveCount : CODEC_CONTEXT_COUNT) - 1;
+}
+
+int GameCodec::getCumulativeFrequency(int context, int symbol)
+{
+    int cumulativeFrequency = 0;
+    for (int i = 0; i < symbol; i++)
+    {
+        cumulativeFrequency += this->frequencies[context][i];
+    }
+    return cumulativeFrequency;
+}
+
+// Only the symbols of this position can be coded
+int GameCodec::getTotalFrequency(int context, int legalMoveCount)
+{
+    return getCumulativeFrequency(context, legalMoveCount);
+}
+
+void GameCodec::updateModel(int context, int symbol)
+{
+    this->frequencies[context][symbol] += CODEC_FREQUENCY_STEP;
+    this->totals[context] += CODEC_FREQUENCY_STEP;
+    if (this->totals[context] > CODEC_MAX_TOTAL)
+    {
+        this->totals[context] = 0;
+        for (int i = 0; i < MAX_MOVES; i++)
+        {
+            this->frequencies[context][i] = (this->frequencies[context][i] + 1) / 2;
+            this->totals[context] += this->frequencies[context][i];
+        }
+    }
+}
@@ -0,0 +1,119 @@
+#include "history.hpp"
+
+constexpr int RESERVED_MOVES = 512;
+
+MoveHistory::MoveHistory()
+{
+    this->encodedLength = 0;
+    this->moves.reserve(RESERVED_MOVES);
+}
+
+// Keeps the capacity, so a new game does not allocate
+void MoveHistory::clear()
+{
+    this->encodedLength = 0;
+    this->moves.clear();
+}
+
+void MoveHistory::addMove(const Move& move)
+{
+    this->moves.push_back(move);
+    this->encodedLength += getEncodedMoveLength(move);
+}
+
+// Drops every move from moveCount on
+void MoveHistory::truncate(int moveCount)
+{
+    for (int i = moveCount; i < getLength(); i++)
+    {
+        this->encodedLength -= getEncodedMoveLength(this->moves[i]);
+    }
+    this->moves.resize(moveCount);
+}
+
+int MoveHistory::getLength() const
+{
+    return this->moves.size();
+}
+
+Move MoveHistory::getMove(int moveIndex) const
+{
+    return this->moves[moveIndex];
+}
+
+int MoveHistory::getEncodedLength() const
+{
+    return this->encodedLength;
+}
+
+void MoveHistory::encode(char* data) const
+{
+    int dataIndex = 0;
+    for (const Move& move : this->moves)
+    {
+        dataIndex += encodeMove(move, data + dataIndex);
+    }
+}
+
+bool MoveHistory::decode(const char* data, int dataLength)
+{
+    clear();
+
+    int dataIndex = 0;
+    while (dataIndex < dataLength)
+    {
+        Move move;
+        int moveLength = decodeMove(data + dataIndex, dataLength - dataIndex, &move);
+        if (moveLength == 0)
+        {
+            return false;
+        }
+        addMove(move);
+        dataIndex += moveLength;
+    }
+    return true;
+}
+
+int MoveHistory::getEncodedMoveLength(const Move& move)
+{
+    return isStackPile(move.from) && isStackPile(move.to) ? 2 : 1;
+}
+
+int MoveHistory::encodeMove(const Move& move, char* data)
+{
+    data[0] = static_cast<char>(move.from << 4 | move.to);
+    if (isStackPile(move.from) && isStackPile(move.to))
+    {
+        data[1] = static_cast<char>(move.count);
+        return 2;
+    }
+    return 1;
+}
+
+int MoveHistory::decodeMove(const char* data, int dataLength, Move* move)
+{
+    if (dataLength < 1)
+    {
+        return 0;
+    }
+
+    unsigned char piles = static_cast<unsigned char>(data[0]);
+    move->from = piles >> 4;
+    move->to = piles & 0xF;
+    move->count = 1;
+    if (move->from >= PILE_COUNT || move->to >= PILE_COUNT)
+    {
+        return 0;
+    }
+
+    if (isStackPile(move->from) && isStackPile(move->to))
+    {
+        if (dataLength < 2 || data[1] < 1 || data[1] > MAX_STACK_LENGTH)
+        {
+            return 0;
+        }
+        move->count = static_cast<uint8_t>(data[1]);
+        return 2;
+    }
+    return 1;
+}
@@ -0,0 +1,424 @@
+#include "lockstep.hpp"
+#include "board.hpp"
+
+#include <algorithm>
+
+// Random bits for a move number, each move takes different bits of the game's random state
+static inline uint16_t makeMoveCode(int priority, uint32_t random, int moveNumber)
+{
+    return static_cast<uint16_t>(priority << 12 | ((random >> (moveNumber % 27)) & 31) << 7 | moveNumber);
+}
+
+static inline uint8_t getCardValue(int cardId)
+{
+    return cardId % MAX_VALUE + 1;
+}
+
+static inline uint8_t getCardSuit(int cardId)
+{
+    return cardId / MAX_VALUE;
+}
+
+// Every foundation is read and one selected, a load that depends on the suit would be a branch
+static inline uint8_t getFoundationLength(const LockstepBlock* block, uint8_t suit, int lane)
+{
+    uint8_t diamonds = block->foundationLengths[Suit::DIAMONDS][lane];
+    uint8_t clubs = block->foundationLengths[Suit::CLUBS][lane];
+    uint8_t hearts = block->foundationLengths[Suit::HEARTS][lane];
+    uint8_t spades = block->foundationLengths[Suit::SPADES][lane];
+    return suit == Suit::DIAMONDS ? diamonds : suit == Suit::CLUBS ? clubs : suit == Suit::HEARTS ? hearts : spades;
+}
+
+// Diamonds and Hearts are 0, Clubs and Spades are 1
+static inline uint8_t getCardColor(int cardId)
+{
+    return getCardSuit(cardId) & 1;
+}
+
+int getLockstepMoveNumber(const Board& board, const Move& move)
+{
+    if (move.from == UNUSED_PILE && move.to == UNUSED_PILE)
+    {
+        return LOCKSTEP_DRAW;
+    }
+    if (isFoundationPile(move.to))
+    {
+        return move.from == UNUSED_PILE ? LOCKSTEP_WASTE_TO_FOUNDATION : isStackPile(move.from) ? move.from - FIRST_STACK_PILE : -1;
+    }
+    if (move.from == UNUSED_PILE)
+    {
+        return LOCKSTEP_FIRST_WASTE_TO_STACK + move.to - FIRST_STACK_PILE;
+    }
+    if (isStackPile(move.from) && isStackPile(move.to))
+    {
+        // Only whole runs, and only off face down cards
+        int s = move.from - FIRST_STACK_PILE;
+        int hiddenCount = board.getHiddenCardCount(s);
+        bool isWholeRun = hiddenCount > 0 && move.count == board.getStackLength(s) - hiddenCount;
+        return isWholeRun ? LOCKSTEP_FIRST_RUN + STACK_COUNT * s + move.to - FIRST_STACK_PILE : -1;
+    }
+    return -1;
+}
+
+LockstepSimulator::LockstepSimulator(int drawCount)
+{
+    this->drawCount = drawCount;
+    this->gameCount = 0;
+    this->isRecording = false;
+}
+
+// Deals every seed the same way Board does
+void LockstepSimulator::deal(const uint32_t* seeds, int seedCount)
+{
+    this->gameCount = seedCount;
+    this->blocks.assign((seedCount + LOCKSTEP_LANES - 1) / LOCKSTEP_LANES, LockstepBlock());
+    this->moves.assign(this->isRecording ? seedCount : 0, vector<Move>());
+
+    for (size_t i = 0; i < this->blocks.size(); i++)
+    {
+        LockstepBlock* block = &this->blocks[i];
+        for (int lane = 0; lane < LOCKSTEP_LANES; lane++)
+        {
+            int gameIndex = i * LOCKSTEP_LANES + lane;
+            if (gameIndex >= seedCount)
+            {
+                continue;
+            }
+
+            Card* deck[MAX_CARDS];
+            Board::shuffleDeck(seeds[gameIndex], deck);
+            int cardIndex = 0;
+            for (int s = 0; s < STACK_COUNT; s++)
+            {
+                for (int j = 0; j <= s; j++)
+                {
+                    block->stackCards[s][j][lane] = getCardId(deck[cardIndex++]);
+                }
+                block->stackLengths[s][lane] = s + 1;
+                block->hiddenCounts[s][lane] = s;
+                updateStack(block, s, lane);
+            }
+            for (int j = 0; cardIndex < MAX_CARDS; j++)
+            {
+                block->unusedCards[j][lane] = getCardId(deck[cardIndex++]);
+            }
+            block->unusedLengths[lane] = RESERVED_CARDS;
+            updateWaste(block, lane);
+
+            block->playingMasks[lane] = 0xFF;
+            // xorshift needs a state that is not 0
+            block->randomStates[lane] = seeds[gameIndex] * 2654435761u | 1;
+        }
+    }
+}
+
+int LockstepSimulator::run()
+{
+    // Blocks whose games are all over drop out, the rest stay in order
+    vector<LockstepBlock*> playingBlocks;
+    for (LockstepBlock& block : this->blocks)
+    {
+        playingBlocks.push_back(&block);
+    }
+
+    int stepCount = 0;
+    while (!playingBlocks.empty())
+    {
+        size_t playingCount = 0;
+        for (LockstepBlock* block : playingBlocks)
+        {
+            if (step(block))
+            {
+                playingBlocks[playingCount++] = block;
+            }
+        }
+        playingBlocks.resize(playingCount);
+        stepCount++;
+    }
+    return stepCount;
+}
+
+int LockstepSimulator::getGameCount()
+{
+    return this->gameCount;
+}
+
+bool LockstepSimulator::getIsWon(int gameIndex)
+{
+    const LockstepBlock& block = this->blocks[gameIndex / LOCKSTEP_LANES];
+    int foundationCards = 0;
+    for (int i = 0; i < FOUNDATION_COUNT; i++)
+    {
+        foundationCards += block.foundationLengths[i][gameIndex % LOCKSTEP_LANES];
+    }
+    return foundationCards == MAX_CARDS;
+}
+
+int LockstepSimulator::getMoveCount(int gameIndex)
+{
+    return this->blocks[gameIndex / LOCKSTEP_LANES].moveCounts[gameIndex % LOCKSTEP_LANES];
+}
+
+// Takes effect on the next deal
+void LockstepSimulator::setIsRecording(bool isRecording)
+{
+    this->isRecording = isRecording;
+}
+
+const vector<Move>& LockstepSimulator::getMoves(int gameIndex)
+{
+    return this->moves[gameIndex];
+}
+
+// One move for every game of the block still being played, returns whether any is left
+bool LockstepSimulator::step(LockstepBlock* block)
+{
+    findMoves(block);
+
+    bool isPlaying = false;
+    int firstGameIndex = (block - this->blocks.data()) * LOCKSTEP_LANES;
+    for (int lane = 0; lane < LOCKSTEP_LANES; lane++)
+    {
+        if (block->playingMasks[lane] == 0)
+        {
+            continue;
+        }
+
+        uint16_t moveCode = block->moveCodes[lane];
+        if (moveCode == 0)
+        {
+            block->playingMasks[lane] = 0;
+            continue;
+        }
+        applyMove(block, firstGameIndex + lane, lane, moveCode & 127);
+        block->moveCounts[lane]++;
+
+        int foundationCards = 0;
+        for (int i = 0; i < FOUNDATION_COUNT; i++)
+        {
+            foundationCards += block->foundationLengths[i][lane];
+        }
+        // Two passes through the stock and a redeal each, without any other move
+        int drawLimit = 2 * (block->unusedLengths[lane] / this->drawCount + 2);
+        if (foundationCards == MAX_CARDS || block->moveCounts[lane] >= LOCKSTEP_MAX_MOVES || block->drawStreaks[lane] > drawLimit)
+        {
+            block->playingMasks[lane] = 0;
+            continue;
+        }
+        isPlaying = true;
+    }
+    return isPlaying;
+}
+
+/*
+The best move code of every game in the block, 0 if it has no move
+Every loop runs over all lanes with no early exit, so each compiles to vector compares, selects and maxes
+*/
+void LockstepSimulator::findMoves(LockstepBlock* block)
+{
+    // xorshift32
+    for (int lane = 0; lane < LOCKSTEP_LANES; lane++)
+    {
+        uint32_t random = block->randomStates[lane];
+        random ^= random << 13;
+        random ^= random >> 17;
+        random ^= random << 5;
+        block->randomStates[lane] = random;
+        block->moveCodes[lane] = 0;
+    }
+
+    // Stack tops to the foundations, a top card fits when its foundation is one shorter than its value
+    for (int s = 0; s < STACK_COUNT; s++)
+    {
+        for (int lane = 0; lane < LOCKSTEP_LANES; lane++)
+        {
+            uint8_t suit = block->topSuits[s][lane];
+            uint8_t foundationLength = getFoundationLength(block, suit, lane);
+            bool isLegal = block->topValues[s][lane] == foundationLength + 1;
+            uint16_t moveCode = makeMoveCode(getLockstepPriority(s), block->randomStates[lane], s) & -static_cast<uint16_t>(isLegal);
+            block->moveCodes[lane] = std::max(block->moveCodes[lane], moveCode);
+        }
+    }
+
+    // The waste to a foundation or a stack
+    for (int lane = 0; lane < LOCKSTEP_LANES; lane++)
+    {
+        uint8_t suit = block->wasteSuits[lane];
+        uint8_t foundationLength = getFoundationLength(block, suit, lane);
+        bool isLegal = block->wasteValues[lane] == foundationLength + 1;
+        uint16_t moveCode = makeMoveCode(getLockstepPriority(LOCKSTEP_WASTE_TO_FOUNDATION), block->randomStates[lane], LOCKSTEP_WASTE_TO_FOUNDATION) & -static_cast<uint16_t>(isLegal);
+        block->moveCodes[lane] = std::max(block->moveCodes[lane], moveCode);
+    }
+    for (int t = 0; t < STACK_COUNT; t++)
+    {
+        int moveNumber = LOCKSTEP_FIRST_WASTE_TO_STACK + t;
+        for (int lane = 0; lane < LOCKSTEP_LANES; lane++)
+        {
+            // Comparisons are combined with & rather than &&, so there is nothing to branch on
+            uint8_t value = block->wasteValues[lane];
+            uint8_t topValue = block->topValues[t][lane];
+            bool isLegal = (value != 0) & (((topValue == value + 1) & (block->topColors[t][lane] != block->wasteColors[lane])) |
+                ((topValue == 0) & (value == MAX_VALUE)));
+            uint16_t moveCode = makeMoveCode(getLockstepPriority(moveNumber), block->randomStates[lane], moveNumber) & -static_cast<uint16_t>(isLegal);
+            block->moveCodes[lane] = std::max(block->moveCodes[lane], moveCode);
+        }
+    }
+
+    // Whole runs off face down cards
+    for (int s = 0; s < STACK_COUNT; s++)
+    {
+        for (int t = 0; t < STACK_COUNT; t++)
+        {
+            if (t == s)
+            {
+                continue;
+            }
+
+            int moveNumber = LOCKSTEP_FIRST_RUN + STACK_COUNT * s + t;
+            for (int lane = 0; lane < LOCKSTEP_LANES; lane++)
+            {
+                uint8_t value = block->baseValues[s][lane];
+                uint8_t topValue = block->topValues[t][lane];
+                bool isLegal = (block->hiddenCounts[s][lane] != 0) & (((topValue == value + 1) & (block->topColors[t][lane] != block->baseColors[s][lane])) |
+                    ((topValue == 0) & (value == MAX_VALUE)));
+                uint16_t moveCode = makeMoveCode(getLockstepPriority(moveNumber), block->randomStates[lane], moveNumber) & -static_cast<uint16_t>(isLegal);
+                block->moveCodes[lane] = std::max(block->moveCodes[lane], moveCode);
+            }
+        }
+    }
+
+    // Draw, or turn the waste over
+    for (int lane = 0; lane < LOCKSTEP_LANES; lane++)
+    {
+        uint16_t moveCode = makeMoveCode(getLockstepPriority(LOCKSTEP_DRAW), block->randomStates[lane], LOCKSTEP_DRAW) & -static_cast<uint16_t>(block->unusedLengths[lane] != 0);
+        moveCode = std::max(block->moveCodes[lane], moveCode);
+        block->moveCodes[lane] = block->playingMasks[lane] != 0 ? moveCode : 0;
+    }
+}
+
+// Same effect as Logic::applyMove with the equivalent move
+void LockstepSimulator::applyMove(LockstepBlock* block, int gameIndex, int lane, int moveNumber)
+{
+    Move move;
+    if (moveNumber < LOCKSTEP_WASTE_TO_FOUNDATION)
+    {
+        // Like Board, every face up card that fits follows the top card
+        int s = moveNumber;
+        int stackLength = block->stackLengths[s][lane];
+        int hiddenCount = block->hiddenCounts[s][lane];
+        move = { static_cast<uint8_t>(FIRST_STACK_PILE + s), static_cast<uint8_t>(FIRST_FOUNDATION_PILE + getCardSuit(block->stackCards[s][stackLength - 1][lane])), 1 };
+        while (stackLength > hiddenCount)
+        {
+            int cardId = block->stackCards[s][stackLength - 1][lane];
+            uint8_t* foundationLength = &block->foundationLengths[getCardSuit(cardId)][lane];
+            if (*foundationLength + 1 != getCardValue(cardId))
+            {
+                break;
+            }
+            (*foundationLength)++;
+            stackLength--;
+        }
+        if (stackLength > 0 && stackLength == hiddenCount)
+        {
+            block->hiddenCounts[s][lane]--;
+        }
+        block->stackLengths[s][lane] = stackLength;
+        updateStack(block, s, lane);
+    }
+    else if (moveNumber < LOCKSTEP_FIRST_RUN)
+    {
+        int wasteLength = block->wasteLengths[lane];
+        int unusedLength = block->unusedLengths[lane];
+        int cardId = block->unusedCards[wasteLength - 1][lane];
+        for (int i = wasteLength; i < unusedLength; i++)
+        {
+            block->unusedCards[i - 1][lane] = block->unusedCards[i][lane];
+        }
+        block->wasteLengths[lane]--;
+        block->unusedLengths[lane]--;
+
+        if (moveNumber == LOCKSTEP_WASTE_TO_FOUNDATION)
+        {
+            block->foundationLengths[getCardSuit(cardId)][lane]++;
+            move = { UNUSED_PILE, static_cast<uint8_t>(FIRST_FOUNDATION_PILE + getCardSuit(cardId)), 1 };
+        }
+        else
+        {
+            int t = moveNumber - LOCKSTEP_FIRST_WASTE_TO_STACK;
+            block->stackCards[t][block->stackLengths[t][lane]++][lane] = cardId;
+            updateStack(block, t, lane);
+            move = { UNUSED_PILE, static_cast<uint8_t>(FIRST_STACK_PILE + t), 1 };
+        }
+        updateWaste(block, lane);
+    }
+    else if (moveNumber < LOCKSTEP_DRAW)
+    {
+        int s = (moveNumber - LOCKSTEP_FIRST_RUN) / STACK_COUNT;
+        int t = (moveNumber - LOCKSTEP_FIRST_RUN) % STACK_COUNT;
+        int hiddenCount = block->hiddenCounts[s][lane];
+        int count = block->stackLengths[s][lane] - hiddenCount;
+        for (int i = 0; i < count; i++)
+        {
+            block->stackCards[t][block->stackLengths[t][lane]++][lane] = block->stackCards[s][hiddenCount + i][lane];
+        }
+        // Only runs off face down cards are moved, so the card below always turns
+        block->stackLengths[s][lane] = hiddenCount;
+        block->hiddenCounts[s][lane] = hiddenCount - 1;
+        updateStack(block, s, lane);
+        updateStack(block, t, lane);
+        move = { static_cast<uint8_t>(FIRST_STACK_PILE + s), static_cast<uint8_t>(FIRST_STACK_PILE + t), static_cast<uint8_t>(count) };
+    }
+    else
+    {
+        int wasteLength = block->wasteLengths[lane];
+        int unusedLength = block->unusedLengths[lane];
+        block->wasteLengths[lane] = wasteLength < unusedLength ? std::min(wasteLength + this->drawCount, unusedLength) : 0;
+        updateWaste(block, lane);
+        move = { UNUSED_PILE, UNUSED_PILE, 1 };
+    }
+
+    block->drawStreaks[lane] = moveNumber == LOCKSTEP_DRAW ? block->drawStreaks[lane] + 1 : 0;
+    if (this->isRecording)
+    {
+        this->moves[gameIndex].push_back(move);
+    }
+}
+
+void LockstepSimulator::updateStack(LockstepBlock* block, int s, int lane)
+{
+    int stackLength = block->stackLengths[s][lane];
+    if (stackLength == 0)
+    {
+        block->topValues[s][lane] = 0;
+        block->topSuits[s][lane] = 0;
+        block->topColors[s][lane] = 0;
+        block->baseValues[s][lane] = 0;
+        block->baseColors[s][lane] = 0;
+        return;
+    }
+
+    int topCardId = block->stackCards[s][stackLength - 1][lane];
+    int baseCardId = block->stackCards[s][block->hiddenCounts[s][lane]][lane];
+    block->topValues[s][lane] = getCardValue(topCardId);
+    block->topSuits[s][lane] = getCardSuit(topCardId);
+    block->topColors[s][lane] = getCardColor(topCardId);
+    block->baseValues[s][lane] = getCardValue(baseCardId);
+    block->baseColors[s][lane] = getCardColor(baseCardId);
+}
+
+void LockstepSimulator::updateWaste(LockstepBlock* block, int lane)
+{
+    int wasteLength = block->wasteLengths[lane];
+    if (wasteLength == 0)
+    {
+        block->wasteValues[lane] = 0;
+        block->wasteSuits[lane] = 0;
+        block->wasteColors[lane] = 0;
+        return;
+    }
+
+    int cardId = block->unusedCards[wasteLength - 1][lane];
+    block->wasteValues[lane] = getCardValue(cardId);
+    block->wasteSuits[lane] = getCardSuit(cardId);
+    block->wasteColors[lane] = getCardColor(cardId);
+}
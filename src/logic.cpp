@@ -1,15 +1,19 @@
 #include "logic.hpp"
 
-Logic::Logic(Board* board, Display* display)
+Logic::Logic(Board* board, Display* display, const BoardView* view, MoveHistory* history)
 {
     this->board = board;
     this->display = display;
+    this->view = view;
+    this->history = history;
 }
 
 Logic::~Logic()
 {
     this->board = nullptr;
     this->display = nullptr;
+    this->view = nullptr;
+    this->history = nullptr;
 }
 
 // First check isGameWon before checking canAutoFinish
@@ -38,29 +42,43 @@ bool Logic::canAutoFinish()
     
     for (int i = 0; i < STACK_COUNT; i++)
     {
-        int stackLength = this->board->getStackLength(i);
-        if (stackLength == 0)
+        if (this->board->getHiddenCardCount(i) > 0)
         {
-            continue;
+            return false;
         }
+    }
+
+    return true;
+}
 
-        Card* bottomCard = this->board->getCardFromStack(i, 0);
-        if (!bottomCard->isFaceUp)
+// Moves every card up to the foundations, only possible once canAutoFinish is true
+bool Logic::autoFinish()
+{
+    Move moves[MAX_MOVES];
+    while (!isGameWon())
+    {
+        // Moves to the foundations are always generated first
+        int moveCount = generateMoves(moves);
+        if (moveCount == 0 || !isFoundationPile(moves[0].to) || !applyMove(moves[0]))
         {
             return false;
         }
     }
-
     return true;
 }
 
+// Fills moves (MAX_MOVES long) with every legal move from the current position
+int Logic::generateMoves(Move* moves)
+{
+    return getRuleSet(this->board->getRuleVariant())->generateMoves(this->board, &this->bitboard, moves);
+}
+
 void Logic::handleUnusedCardSelection(int verticalCursorIndex)
 {
     // If Cursor is on ?/X, shift to next card
     if (verticalCursorIndex == 0)
     {
-        this->board->shiftNextUnusedCard();
-        this->board->addMoves();
+        applyMove({ UNUSED_PILE, UNUSED_PILE, 1 });
     }
     else // lock or unlock cursor
     {
@@ -69,14 +87,15 @@ void Logic::handleUnusedCardSelection(int verticalCursorIndex)
 }
 
 // This action means that the player wants to move cards from some place to this stack
+// The vertical cursor index is the one of the locked (source) pile
 bool Logic::handleStackSelection(int toStackIndex, int fromPileIndex, int verticalCursorIndex)
 {
-    // First we determine the index of the card
+    // First we determine the move
     // Vertical Cursor Index determines the card index in the stack
+    Move move = { UNUSED_PILE, static_cast<uint8_t>(FIRST_STACK_PILE + toStackIndex), 1 };
     if (fromPileIndex == 0) // Unused Pile
     {
         // We know its current unused card, as you can't lock cursor on a hidden/X tile
-        return unusedToStack(toStackIndex);
     }
     else if (fromPileIndex <= STACK_COUNT) // Stack
     {
@@ -87,35 +106,31 @@ bool Logic::handleStackSelection(int toStackIndex, int fromPileIndex, int vertic
             return true;
         }
 
-        // We might have to loop through the stack again ffs...
         int stackLength = this->board->getStackLength(fromStackIndex);
-        if (verticalCursorIndex >= stackLength)
+        if (verticalCursorIndex < 0 || verticalCursorIndex >= stackLength)
         {
             return false;
         }
 
-        int hiddenCount = 0;
-        for (int i = 0; i < stackLength; i++)
-        {
-            Card* card = this->board->getCardFromStack(fromStackIndex, i);
-            if (!card->isFaceUp)
-            {
-                hiddenCount++;
-            }
-        }
         // If there is a hidden card, means 0 to hiddenCount - 1 are hidden and collapsed to verticalCursorIndex 0
+        int hiddenCount = this->view->getStack(fromStackIndex).hiddenCount;
         hiddenCount = hiddenCount > 0 ? hiddenCount - 1 : 0;
         int cardIndex = verticalCursorIndex + hiddenCount;
+        if (cardIndex >= stackLength)
+        {
+            return false;
+        }
 
-        return stackToStack(cardIndex, fromStackIndex, toStackIndex);
+        move.from = FIRST_STACK_PILE + fromStackIndex;
+        move.count = stackLength - cardIndex;
     }
     else // We transferring from foundation
     {
         int foundationPileIndex = fromPileIndex - 1 - STACK_COUNT;
-        int foundationIndex = foundationPileIndex + 2 * verticalCursorIndex;
-        
-        return foundationToStack(foundationIndex, toStackIndex);
+        move.from = FIRST_FOUNDATION_PILE + foundationPileIndex + 2 * verticalCursorIndex;
     }
+
+    return finishSelection(applyMove(move));
 }
 
 bool Logic::handleFoundationSelection(int cursorPileIndex, int verticalCursorIndex)
@@ -126,276 +141,67 @@ bool Logic::handleFoundationSelection(int cursorPileIndex, int verticalCursorInd
     3. Cursor is on unused pile - We try to move the card from the unused pile to the foundation pile
     */
    
+    Card* card = nullptr;
+    Move move = { UNUSED_PILE, FIRST_FOUNDATION_PILE, 1 };
     if (cursorPileIndex == 0) // Unused Pile
     {
-        return unusedToFoundation();
+        card = this->board->getCurrentUnusedCard();
     }
     else if (cursorPileIndex <= STACK_COUNT) // Stack
     {
         int stackIndex = cursorPileIndex - 1;
-        return stackToFoundation(stackIndex);
+        int stackLength = this->board->getStackLength(stackIndex);
+        card = stackLength > 0 ? this->board->getCardFromStack(stackIndex, stackLength - 1) : nullptr;
+        move.from = FIRST_STACK_PILE + stackIndex;
     }
     else // Foundation
     {
         this->display->getCursor()->updateCursorLock(true);
         return true;
     }
-}
-
-// Move cards from one stack to another stack
-// We can use enum to represent the return values and tell the player what went wrong
-bool Logic::stackToStack(int cardIndex, int fromStackIndex, int toStackIndex)
-{
-    // Get the stack length
-    int fromStackLength = this->board->getStackLength(fromStackIndex);
-    if (cardIndex >= fromStackLength)
-    {
-        return false;
-    }
-
-    // Get the cards that will be moved from the stack
-    // Example: If the stack has 5 cards and the cardIndex is 2, then 3 cards will be moved (2, 3, 4)
-    int numCardsToMove = fromStackLength - cardIndex;
-    Card* cardsToMove[numCardsToMove];
-    for (int i = 0; i < numCardsToMove; ++i)
-    {
-        cardsToMove[i] = this->board->getCardFromStack(fromStackIndex, cardIndex + i);
-        // If any of the cards are face down, then we can't move them
-        if (!cardsToMove[i]->isFaceUp)
-        {
-            return false;
-        }
-    }
-
-    // If toStack is empty, then we can move only King-stacks
-    if (this->board->getStackLength(toStackIndex) == 0)
-    {
-        if (canEmptyStackAcceptCard(cardsToMove[0]) == false)
-        {
-            return false;
-        }
-    }
-    else
-    {
-        // If toStack is not empty, then we can move only cards that are in descending order and alternate colors
-        Card* toTopCard = this->board->getCardFromStack(toStackIndex, this->board->getStackLength(toStackIndex) - 1);
-        if (canExistingStackAcceptCard(toTopCard, cardsToMove[0]) == false)
-        {
-            return false;
-        }
-    }
 
-    // Move the cards to the stack
-    for (int i = 0; i < numCardsToMove; i++)
-    {
-        this->board->removeCardFromStack(fromStackIndex);
-        this->board->addCardToStack(toStackIndex, cardsToMove[i]);
-    }
-    // Unlock the cursor
-    this->display->getCursor()->updateCursorLock(true);
-    this->board->addMoves();
-    return true;
-}
-
-bool Logic::stackToFoundation(int stackIndex)
-{
-    bool hasTransferredCard = false;
-    
-    while (true)
-    {
-        // Get the stack length
-        int stackLength = this->board->getStackLength(stackIndex);
-        if (stackLength == 0)
-        {
-            break;
-        }
-
-        // Get the card that will be moved from the stack
-        Card* card = this->board->getCardFromStack(stackIndex, stackLength - 1);
-        if (!card->isFaceUp)
-        {
-            break;
-        }
-
-        // Get suit of the card
-        int cardSuit = static_cast<int>(card->suit);
-        int foundationLength = this->board->getFoundationLength(cardSuit);
-        if (foundationLength == 0)
-        {
-            // If the foundation is empty, then we can move only Ace-cards
-            if (canEmptyFoundationAcceptCard(card) == false)
-            {
-                break;
-            }
-        }
-        else
-        {
-            // If the foundation is not empty, then we can move only cards that are in ascending order and same suit
-            Card* foundationTopCard = this->board->getCardFromFoundation(cardSuit, foundationLength - 1);
-            if (canExistingFoundationAcceptCard(foundationTopCard, card) == false)
-            {
-                break;
-            }
-        }
-
-        // Move the card to the foundation
-        this->board->removeCardFromStack(stackIndex);
-        this->board->addCardToFoundation(cardSuit, card);
-        hasTransferredCard = true;
-    }
-
-    if (hasTransferredCard)
-    {
-        // Unlock the cursor
-        this->display->getCursor()->updateCursorLock(true);
-        this->board->addMoves();
-        return true;
-    }
-    else
+    // The foundation is always the one of the card's suit
+    if (card == nullptr)
     {
         return false;
     }
+    move.to = FIRST_FOUNDATION_PILE + card->suit;
+    return finishSelection(applyMove(move));
 }
 
-bool Logic::unusedToStack(int stackIndex)
+// Headless entry point, the move is validated against the current position by the rules of its board
+bool Logic::applyMove(const Move& move)
 {
-    // Get the card that will be moved from the unused cards
-    Card* card = this->board->getCurrentUnusedCard();
-    if (card == nullptr)
+    if (!getRuleSet(this->board->getRuleVariant())->applyMove(this->board, move))
     {
         return false;
     }
 
-    // Get the stack length
-    int stackLength = this->board->getStackLength(stackIndex);
-
-    // Check the last card in the stack and see if it is compatible
-    if (stackLength > 0)
+    // Only stack to stack moves carry a count, a chain of cards to a foundation is 1 move
+    Move recordedMove = move;
+    if (!isStackPile(move.from) || !isStackPile(move.to))
     {
-        Card* toTopCard = this->board->getCardFromStack(stackIndex, stackLength - 1);
-        if (toTopCard == nullptr || !canExistingStackAcceptCard(toTopCard, card))
-        {
-            return false;
-        }
+        recordedMove.count = 1;
     }
-    else
-    {
-        if (!canEmptyStackAcceptCard(card))
-        {
-            return false;
-        }
-    }
-
-    // Move the card to the stack
-    this->board->removeUnusedCard();
-    this->board->addCardToStack(stackIndex, card);
-
-    // Unlock the cursor
-    this->display->getCursor()->updateCursorLock(true);
-    this->board->addMoves();
+    recordMove(recordedMove);
     return true;
 }
 
-bool Logic::unusedToFoundation()
+// Unlock the cursor after a successful move
+bool Logic::finishSelection(bool hasMoved)
 {
-    // Get the card that will be moved from the unused cards
-    Card* card = this->board->getCurrentUnusedCard();
-    if (card == nullptr)
+    if (hasMoved)
     {
-        return false;
-    }
-
-    // Get suit of the card
-    int cardSuit = static_cast<int>(card->suit);
-    int foundationLength = this->board->getFoundationLength(cardSuit);
-    if (foundationLength == 0)
-    {
-        // If the foundation is empty, then we can move only Ace-cards
-        if (canEmptyFoundationAcceptCard(card) == false)
-        {
-            return false;
-        }
-    }
-    else
-    {
-        // If the foundation is not empty, then we can move only cards that are in ascending order and same suit
-        Card* foundationTopCard = this->board->getCardFromFoundation(cardSuit, foundationLength - 1);
-        if (canExistingFoundationAcceptCard(foundationTopCard, card) == false)
-        {
-            return false;
-        }
+        this->display->getCursor()->updateCursorLock(true);
     }
-
-    // Move the card to the foundation
-    this->board->removeUnusedCard();
-    this->board->addCardToFoundation(cardSuit, card);
-
-    // Unlock the cursor
-    this->display->getCursor()->updateCursorLock(true);
-    this->board->addMoves();
-    return true;
+    return hasMoved;
 }
 
-bool Logic::foundationToStack(int foundationIndex, int stackIndex)
+void Logic::recordMove(const Move& move)
 {
-    // Get the stack length
-    int stackLength = this->board->getStackLength(stackIndex);
-    if (stackLength == 0)
-    {
-        return false;
-    }
-
-    // Get the card that will be moved from the foundation
-    Card* card = this->board->getCardFromFoundation(foundationIndex, this->board->getFoundationLength(foundationIndex) - 1);
-    if (!card->isFaceUp)
-    {
-        return false;
-    }
-
-    // If toStack is empty, then we can move only King-stacks
-    if (this->board->getStackLength(stackIndex) == 0)
+    this->board->addMoves();
+    if (this->history != nullptr)
     {
-        if (canEmptyStackAcceptCard(card) == false)
-        {
-            return false;
-        }
+        this->history->addMove(move);
     }
-    else
-    {
-        // If toStack is not empty, then we can move only cards that are in descending order and alternate colors
-        Card* toTopCard = this->board->getCardFromStack(stackIndex, stackLength - 1);
-        if (canExistingStackAcceptCard(toTopCard, card) == false)
-        {
-            return false;
-        }
-    }
-
-    // Move the card to the stack
-    this->board->removeCardFromFoundation(foundationIndex);
-    this->board->addCardToStack(stackIndex, card);
-
-    // Unlock the cursor
-    this->display->getCursor()->updateCursorLock(true);
-    this->board->addMoves();
-    return true;
-}
-
-bool Logic::canExistingStackAcceptCard(Card* toCard, Card* fromCard)
-{
-    return (toCard->value - 1 == fromCard->value) && (isRed(toCard->suit) != isRed(fromCard->suit));
 }
-
-bool Logic::canEmptyStackAcceptCard(Card* card)
-{
-    return card->value == 13;
-}
-
-bool Logic::canEmptyFoundationAcceptCard(Card* card)
-{
-    return card->value == 1;
-}
-
-bool Logic::canExistingFoundationAcceptCard(Card* toCard, Card* fromCard)
-{
-    return (toCard->value + 1 == fromCard->value) && (toCard->suit == fromCard->suit);
-}
\ No newline at end of file
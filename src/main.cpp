@@ -1,10 +1,396 @@
 #include "common.hpp"
 #include "game.hpp"
 #include "display.hpp"
+#include "board.hpp"
+#include "archive.hpp"
+#include "gamecodec.hpp"
+#include "persistence.hpp"
+#include "replay.hpp"
+#include "rules.hpp"
+#include "server.hpp"
+#include "bot.hpp"
+#include "tournament.hpp"
+#include "solver.hpp"
+#include "bench.hpp"
 
-int main()
+#include <cstring>
+
+// Win rate by move count over the whole archive, printed without starting the game
+static int printArchiveStats()
+{
+    ArchiveReader reader;
+    if (!reader.open(ARCHIVE_NAME))
+    {
+        std::cout << "Unable to read " << ARCHIVE_NAME << std::endl;
+        return 1;
+    }
+
+    constexpr uint32_t BUCKET_SIZE = 25;
+    vector<uint64_t> games;
+    vector<uint64_t> wins;
+    reader.countWinsByMoveCount(BUCKET_SIZE, &games, &wins);
+
+    std::cout << reader.getRecordCount() << " games" << std::endl;
+    std::cout << "Moves        Games       Wins  Win rate" << std::endl;
+    for (size_t i = 0; i < games.size(); i++)
+    {
+        if (games[i] == 0)
+        {
+            continue;
+        }
+        char line[64];
+        snprintf(line, sizeof(line), "%4u-%-4u %8llu %10llu  %6.2f%%", static_cast<unsigned>(i * BUCKET_SIZE), static_cast<unsigned>((i + 1) * BUCKET_SIZE - 1),
+            static_cast<unsigned long long>(games[i]), static_cast<unsigned long long>(wins[i]), 100.0 * wins[i] / games[i]);
+        std::cout << line << std::endl;
+    }
+    return 0;
+}
+
+// The deal column of a record must be the deal of its seed
+static bool isDealOfSeed(const char* deal, uint32_t seed)
+{
+    Card* deck[MAX_CARDS];
+    Board::shuffleDeck(seed, deck);
+    char seedDeal[MAX_CARDS];
+    int dealIndex = 0;
+    for (int i = 0; i < MAX_CARDS; i++)
+    {
+        Persistence::writeCardData(deck[i], true, seedDeal, &dealIndex);
+    }
+    return memcmp(deal, seedDeal, MAX_CARDS) == 0;
+}
+
+// Replays every archived game whose moves replay from its deal, and checks its deal, moves and result
+static int verifyArchive()
 {
-    Game game;
+    ArchiveReader reader;
+    if (!reader.open(ARCHIVE_NAME))
+    {
+        std::cout << "Unable to read " << ARCHIVE_NAME << std::endl;
+        return 1;
+    }
+
+    GameCodec codec;
+    vector<Move> moves;
+    uint64_t gameCount = 0;
+    uint64_t skippedCount = 0;
+    uint64_t unknownDealCount = 0;
+    uint64_t invalidCount = 0;
+    uint64_t moveCount = 0;
+    auto startTime = std::chrono::steady_clock::now();
+
+    uint64_t recordIndex = 0;
+    for (int i = 0; i < reader.getBlockCount(); i++)
+    {
+        ArchiveBlock block = reader.getBlock(i);
+        for (int j = 0; j < block.recordCount; j++, recordIndex++)
+        {
+            if (block.seeds[j] == 0)
+            {
+                skippedCount++;
+                unknownDealCount += block.deals[j * MAX_CARDS] == -1;
+                continue;
+            }
+
+            uint32_t movesEnd = j + 1 < block.recordCount ? block.moveOffsets[j + 1] : block.movesLength;
+            // Decoding replays the game, every decoded move is legal
+            bool isDecoded = block.ruleVariants[j] < RULE_VARIANT_COUNT && codec.decode(block.seeds[j], static_cast<RuleVariant>(block.ruleVariants[j]),
+                block.moves + block.moveOffsets[j], movesEnd - block.moveOffsets[j], &moves);
+            gameCount++;
+            moveCount += moves.size();
+
+            bool isDealValid = isDealOfSeed(block.deals + j * MAX_CARDS, block.seeds[j]);
+
+            if (!isDecoded || !isDealValid || moves.size() != block.moveCounts[j] || codec.isGameWon() != (block.results[j] == GameResult::WON))
+            {
+                if (invalidCount < 10)
+                {
+                    std::cout << "Game " << recordIndex << ": " << (!isDecoded ? "moves are corrupt" : !isDealValid ? "deal does not match its seed" : "result does not match") << std::endl;
+                }
+                invalidCount++;
+            }
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    std::cout << gameCount << " games replayed (" << skippedCount << " not replayable, " << unknownDealCount << " of them without a known deal), " << invalidCount << " invalid" << std::endl;
+    std::cout << moveCount << " moves in " << seconds << "s" << std::endl;
+    return invalidCount == 0 ? 0 : 1;
+}
+
+// Reads <seed> [moves...] with the moves in move notation, stopping at the next option
+static bool readMoveArgs(int argc, char* argv[], int seedIndex, uint32_t* seed, vector<Move>* moves)
+{
+    if (seedIndex >= argc)
+    {
+        std::cout << "Usage: " << argv[seedIndex - 1] << " <seed> [moves...]" << std::endl;
+        return false;
+    }
+    *seed = strtoul(argv[seedIndex], nullptr, 10);
+
+    for (int i = seedIndex + 1; i < argc && string(argv[i]).compare(0, 2, "--") != 0; i++)
+    {
+        Move move;
+        if (!parseMove(argv[i], &move))
+        {
+            std::cout << "Unknown move " << moves->size() << ": " << argv[i] << std::endl;
+            return false;
+        }
+        moves->push_back(move);
+    }
+    return true;
+}
+
+static bool checkReplay(uint32_t seed, RuleVariant ruleVariant, const vector<Move>& moves, ReplayResult* result)
+{
+    Replay replay;
+    *result = replay.run(seed, ruleVariant, moves.data(), moves.size());
+    if (result->illegalMoveIndex >= 0)
+    {
+        std::cout << "Illegal move " << result->illegalMoveIndex << ": " << formatMove(moves[result->illegalMoveIndex]) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Replays one deal from its seed and moves in move notation, e.g. --replay 42 s w3 35x2
+static int printReplay(int argc, char* argv[], int seedIndex, RuleVariant ruleVariant)
+{
+    uint32_t seed;
+    vector<Move> moves;
+    ReplayResult result;
+    if (!readMoveArgs(argc, argv, seedIndex, &seed, &moves) || !checkReplay(seed, ruleVariant, moves, &result))
+    {
+        return 1;
+    }
+    std::cout << result.appliedMoveCount << " moves, " << (result.isWon ? "won" : "not won") << std::endl;
+    return 0;
+}
+
+// Shortest win from the position after the moves given, e.g. --endgame 42 s w3 35x2
+// Only endgames are solved within the budget, further out it prints a lower bound
+static int printEndgame(int argc, char* argv[], int seedIndex, RuleVariant ruleVariant)
+{
+    uint32_t seed;
+    vector<Move> moves;
+    if (!readMoveArgs(argc, argv, seedIndex, &seed, &moves))
+    {
+        return 1;
+    }
+    Replay replay;
+    replay.deal(seed, ruleVariant);
+    for (size_t i = 0; i < moves.size(); i++)
+    {
+        if (!replay.applyMove(moves[i]))
+        {
+            std::cout << "Illegal move " << i << ": " << formatMove(moves[i]) << std::endl;
+            return 1;
+        }
+    }
+
+    EndgameSolver solver(ruleVariant);
+    auto startTime = std::chrono::steady_clock::now();
+    EndgameResult result = solver.solve(*replay.getBoard(), ENDGAME_NODE_BUDGET);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    if (result.isWon)
+    {
+        std::cout << "Shortest win from move " << moves.size() << ": " << result.moveCount << " moves, " << moves.size() + result.moveCount << " for the game" << std::endl;
+        for (size_t i = 0; i < result.moves.size(); i++)
+        {
+            std::cout << (i > 0 ? " " : "") << formatMove(result.moves[i]);
+        }
+        std::cout << std::endl;
+    }
+    else if (result.hasNoWin)
+    {
+        std::cout << "No win from move " << moves.size() << std::endl;
+    }
+    else
+    {
+        std::cout << "Every win from move " << moves.size() << " needs at least " << result.moveCount << " moves, the search stopped there" << std::endl;
+    }
+    std::cout << result.nodeCount << " positions in " << seconds << "s" << std::endl;
+    return 0;
+}
+
+// Reads the deal and moves of the archived game at recordIndex, counting from the first game
+static bool readArchivedGame(uint64_t recordIndex, uint32_t* seed, RuleVariant* ruleVariant, vector<Move>* moves)
+{
+    ArchiveReader reader;
+    if (!reader.open(ARCHIVE_NAME))
+    {
+        std::cout << "Unable to read " << ARCHIVE_NAME << std::endl;
+        return false;
+    }
+
+    for (int i = 0; i < reader.getBlockCount(); i++)
+    {
+        ArchiveBlock block = reader.getBlock(i);
+        if (recordIndex >= static_cast<uint64_t>(block.recordCount))
+        {
+            recordIndex -= block.recordCount;
+            continue;
+        }
+
+        int j = static_cast<int>(recordIndex);
+        if (block.seeds[j] == 0)
+        {
+            std::cout << (block.deals[j * MAX_CARDS] == -1 ? "The deal of this game is unknown" : "The moves of this game do not replay from its deal") << std::endl;
+            return false;
+        }
+
+        GameCodec codec;
+        uint32_t movesEnd = j + 1 < block.recordCount ? block.moveOffsets[j + 1] : block.movesLength;
+        if (block.ruleVariants[j] >= RULE_VARIANT_COUNT || !codec.decode(block.seeds[j], static_cast<RuleVariant>(block.ruleVariants[j]),
+            block.moves + block.moveOffsets[j], movesEnd - block.moveOffsets[j], moves))
+        {
+            std::cout << "The moves of this game are corrupt" << std::endl;
+            return false;
+        }
+        *seed = block.seeds[j];
+        *ruleVariant = static_cast<RuleVariant>(block.ruleVariants[j]);
+        return true;
+    }
+
+    std::cout << ARCHIVE_NAME << " has only " << reader.getRecordCount() << " games" << std::endl;
+    return false;
+}
+
+int main(int argc, char* argv[])
+{
+    // Commands that run without the game
+    bool isDrawThree = false;
+    bool isVegas = false;
+    bool isThoughtful = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (string(argv[i]) == "--draw3")
+        {
+            isDrawThree = true;
+        }
+        else if (string(argv[i]) == "--vegas")
+        {
+            isVegas = true;
+        }
+        else if (string(argv[i]) == "--thoughtful")
+        {
+            isThoughtful = true;
+        }
+    }
+    RuleVariant ruleVariant = isVegas ? (isDrawThree ? RuleVariant::VEGAS_DRAW_THREE_RULES : RuleVariant::VEGAS_RULES) :
+        (isDrawThree ? RuleVariant::DRAW_THREE_RULES : RuleVariant::STANDARD_RULES);
+    for (int i = 1; i < argc; i++)
+    {
+        if (string(argv[i]) == "--stats")
+        {
+            return printArchiveStats();
+        }
+        else if (string(argv[i]) == "--verify")
+        {
+            return verifyArchive();
+        }
+        else if (string(argv[i]) == "--server")
+        {
+            // Options that follow are not the socket or worker count
+            bool hasSocketName = i + 1 < argc && argv[i + 1][0] != '-';
+            bool hasWorkerCount = hasSocketName && i + 2 < argc && argv[i + 2][0] != '-';
+            int workerCount = hasWorkerCount ? atoi(argv[i + 2]) : std::thread::hardware_concurrency();
+            GameServer server(ruleVariant, workerCount > 0 ? workerCount : 1);
+            return server.run(hasSocketName ? argv[i + 1] : SERVER_SOCKET_NAME);
+        }
+        else if (string(argv[i]) == "--bot")
+        {
+            BotPipe bot(ruleVariant);
+            return bot.run();
+        }
+        else if (string(argv[i]) == "--tournament")
+        {
+            bool hasDealCount = i + 1 < argc && argv[i + 1][0] != '-';
+            bool hasThreadCount = hasDealCount && i + 2 < argc && argv[i + 2][0] != '-';
+            int dealCount = hasDealCount ? atoi(argv[i + 1]) : 1000;
+            int threadCount = hasThreadCount ? atoi(argv[i + 2]) : std::thread::hardware_concurrency();
+            Tournament tournament(ruleVariant, dealCount > 0 ? dealCount : 1, threadCount > 0 ? threadCount : 1);
+            tournament.run();
+            tournament.printReport();
+            return 0;
+        }
+        else if (string(argv[i]) == "--lockstep")
+        {
+            int games = i + 1 < argc && argv[i + 1][0] != '-' ? atoi(argv[i + 1]) : 4096;
+            return printLockstep(games > 0 ? games : 1, isDrawThree ? RuleVariant::DRAW_THREE_RULES : RuleVariant::STANDARD_RULES);
+        }
+        else if (string(argv[i]) == "--endgame")
+        {
+            return printEndgame(argc, argv, i + 1, ruleVariant);
+        }
+        else if (string(argv[i]) == "--replay")
+        {
+            return printReplay(argc, argv, i + 1, ruleVariant);
+        }
+    }
+
+    // A game for the replay viewer is checked before the display takes over the terminal
+    bool hasReplay = false;
+    uint32_t replaySeed = 0;
+    RuleVariant replayVariant = ruleVariant;
+    vector<Move> replayMoves;
+    for (int i = 1; i < argc && !hasReplay; i++)
+    {
+        ReplayResult result;
+        if (string(argv[i]) == "--view")
+        {
+            if (!readMoveArgs(argc, argv, i + 1, &replaySeed, &replayMoves) || !checkReplay(replaySeed, replayVariant, replayMoves, &result))
+            {
+                return 1;
+            }
+            hasReplay = true;
+        }
+        else if (string(argv[i]) == "--view-archive")
+        {
+            if (i + 1 >= argc)
+            {
+                std::cout << "Usage: --view-archive <game>" << std::endl;
+                return 1;
+            }
+            if (!readArchivedGame(strtoull(argv[i + 1], nullptr, 10), &replaySeed, &replayVariant, &replayMoves))
+            {
+                return 1;
+            }
+            hasReplay = true;
+        }
+    }
+
+    Game game(isThoughtful);
+    if (!game.getIsRunning())
+    {
+        // The terminal is too small, the display has said so
+        return 1;
+    }
+    game.setRuleVariant(ruleVariant);
+    bool hasAutosave = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (string(argv[i]) == "--autosave")
+        {
+            hasAutosave = true;
+        }
+        else if (string(argv[i]) == "--archive")
+        {
+            game.enableArchive();
+        }
+    }
+
+    // After the options, so a recovered game keeps its own rules
+    if (hasReplay)
+    {
+        game.startReplayViewer(replaySeed, replayVariant, replayMoves.data(), replayMoves.size());
+    }
+    else if (hasAutosave)
+    {
+        game.enableAutosave();
+    }
     
     Display* display = game.getDisplay();
     display->render(); // First render - delete if want animations and unblocking input
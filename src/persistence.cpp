@@ -1,4 +1,13 @@
 #include "persistence.hpp"
+#include "rules.hpp"
+
+#include <algorithm>
+
+#ifdef _WIN32
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
 
 /* Save the game in the format
 Stack Piles SEP Foundation Piles SEP UnusedCount[1] Unused Pile SEP Move Count[2]
@@ -13,33 +22,92 @@ SEP: 255/-1
 Minimum size: 4 Cards * 1 byte char + 9 new lines * 1 byte (char sep, -128) + 1 byte unusedCardIndex + 2 bytes for move count = 16 bytes
 Maximum size: 52 Cards * 1 byte char + 9 new lines * 1 byte (char sep, -128) + 1 byte unusedCardIndex + 2 bytes for move count = 64 bytes
 Note that if foundation piles are filled (like up to 5H) then we can omit 4 cards (AH-4H)
+
+The above is the v1 format, which is now the body of the v3 format:
+Magic[4] Version[1] Rule Variant[1] Redeal Count[1] CRC32[4] | Seed[4] Journal Length[4] Journal Body
+
+The CRC32 covers everything after the header, multi byte numbers are big endian
+The redeal count is capped at 255, only the Vegas variants limit it and they allow far fewer
+v2 has a draw count in place of the rule variant and no redeal count, it loads as the standard rules with that draw count
+The journal is the move history, see MoveHistory for its encoding
+A v1 file can never start with the magic, since its first byte is a card or a SEP
 */
 
-Persistence::Persistence(Board* board, Card** deck)
+constexpr char SAVEFILE_MAGIC[SAVEFILE_MAGIC_LENGTH] = { 'S', 'O', 'L', 0x1A };
+
+Persistence::Persistence(Board* board, MoveHistory* history)
 {
     this->board = board;
-    this->deck = deck;
+    this->history = history;
+    this->checksum = 0;
 }
 
 Persistence::~Persistence()
 {
     this->board = nullptr;
-    this->deck = nullptr;
+    this->history = nullptr;
 }
 
 bool Persistence::saveFile()
 {
-    std::ofstream saveFile(SAVEFILE_NAME, std::ios::binary);
+    return saveFile(SAVEFILE_NAME);
+}
+
+bool Persistence::loadFile()
+{
+    return loadFile(SAVEFILE_NAME);
+}
+
+// Saves a snapshot of the game, the live board is only copied from
+bool Persistence::saveFile(const char* fileName)
+{
+    takeSnapshot(&this->snapshot);
+    return writeFile(fileName, this->snapshot, &this->checksum);
+}
+
+// Copies everything a save needs, reusing the snapshot's storage
+void Persistence::takeSnapshot(SaveSnapshot* snapshot)
+{
+    snapshot->board = *this->board;
+    snapshot->history = *this->history;
+}
+
+// Only reads the snapshot, so it is safe to call from any thread that owns it
+bool Persistence::writeFile(const char* fileName, const SaveSnapshot& snapshot, uint32_t* checksum)
+{
+    std::ofstream saveFile(fileName, std::ios::binary);
     if (saveFile.is_open())
     {
-        int saveDataLength = getArrayLength();
-        char* saveData = writeSaveData(saveDataLength);
-
-        saveFile.write(saveData, saveDataLength);
+        const Board& board = snapshot.board;
+        int bodyLength = getArrayLength(board);
+        int journalLength = snapshot.history.getEncodedLength();
+        int saveDataLength = SAVEFILE_HEADER_LENGTH + 8 + journalLength + bodyLength;
+        vector<char> saveData(saveDataLength);
+
+        // Header
+        int saveDataIndex = 0;
+        for (int i = 0; i < SAVEFILE_MAGIC_LENGTH; i++)
+        {
+            saveData[saveDataIndex++] = SAVEFILE_MAGIC[i];
+        }
+        saveData[saveDataIndex++] = SAVEFILE_VERSION;
+        saveData[saveDataIndex++] = board.getRuleVariant();
+        saveData[saveDataIndex++] = std::min(board.getRedealCount(), 0xFF);
+        int checksumIndex = saveDataIndex;
+        saveDataIndex += 4;
+
+        writeUint32(board.getSeed(), saveData.data(), &saveDataIndex);
+        writeUint32(journalLength, saveData.data(), &saveDataIndex);
+        snapshot.history.encode(saveData.data() + saveDataIndex);
+        saveDataIndex += journalLength;
+        writeSaveData(board, saveData.data() + saveDataIndex);
+
+        *checksum = getChecksum(saveData.data() + SAVEFILE_HEADER_LENGTH, saveDataLength - SAVEFILE_HEADER_LENGTH);
+        writeUint32(*checksum, saveData.data(), &checksumIndex);
+
+        saveFile.write(saveData.data(), saveDataLength);
         saveFile.close();
-        delete[] saveData;
-
-        return true;
+        return saveFile.good();
     }
     else // Error saving the file, Maybe print error message at display
     {
@@ -47,10 +115,10 @@ bool Persistence::saveFile()
     }
 }
 
-bool Persistence::loadFile()
+bool Persistence::loadFile(const char* fileName)
 {
     // Load the game
-    std::ifstream saveFile(SAVEFILE_NAME, std::ios::binary);
+    std::ifstream saveFile(fileName, std::ios::binary);
     if (saveFile.is_open())
     {
         // Read the save data
@@ -58,17 +126,32 @@ bool Persistence::loadFile()
         int saveDataLength = saveFile.tellg();
         saveFile.seekg(0, saveFile.beg);
 
-        // Size must >= 16 bytes and <= 64 bytes
-        if (saveDataLength < 16 || saveDataLength > 64)
+        if (saveDataLength < V1_MIN_LENGTH || saveDataLength > MAX_SAVEFILE_LENGTH)
         {
             return false;
         }
 
-        char saveData[saveDataLength]; // Read bottom comment for the size calculation
-        saveFile.read(saveData, saveDataLength);
+        // The whole file is read at once, then parsed in place
+        vector<char> saveData(saveDataLength);
+        saveFile.read(saveData.data(), saveDataLength);
+        if (saveFile.gcount() != saveDataLength)
+        {
+            return false;
+        }
         saveFile.close();
 
-        return readSaveData(saveData, saveDataLength);
+        if (hasMagic(saveData.data(), saveDataLength))
+        {
+            return readVersionedData(saveData.data(), saveDataLength);
+        }
+
+        // Size must >= 16 bytes and <= 64 bytes for v1
+        if (saveDataLength > V1_MAX_LENGTH)
+        {
+            return false;
+        }
+        this->checksum = getChecksum(saveData.data(), saveDataLength);
+        return readSaveData(this->board, saveData.data(), saveDataLength);
     }
     else // Error loading the file, Maybe print error message at display
     {
@@ -76,6 +159,29 @@ bool Persistence::loadFile()
     }
 }
 
+// Writes the packed position alone (the v1 body), returns its length
+int Persistence::writeRecord(const Board& board, char* record)
+{
+    writeSaveData(board, record);
+    return getArrayLength(board);
+}
+
+// Reads a packed position into a board reset for loading, returns false if the record is not a valid position
+bool Persistence::readRecord(Board* board, const char* record, int recordLength)
+{
+    if (recordLength < V1_MIN_LENGTH || recordLength > V1_MAX_LENGTH)
+    {
+        return false;
+    }
+    return readSaveData(board, record, recordLength);
+}
+
+// Checksum of the last saved or loaded file, identifies its content
+uint32_t Persistence::getLastChecksum()
+{
+    return this->checksum;
+}
+
 void Persistence::saveDebugInfo(string text)
 {
     std::ofstream debugFile("debug.txt");
@@ -86,12 +192,12 @@ void Persistence::saveDebugInfo(string text)
     }
 }
 
-int Persistence::getArrayLength()
+int Persistence::getArrayLength(const Board& board)
 {
     int omittedCount = 0;
     for (int i = 0; i < FOUNDATION_COUNT; i++)
     {
-        int foundationLength = this->board->getFoundationLength(i);
+        int foundationLength = board.getFoundationLength(i);
         if (foundationLength > 0)
         {
             omittedCount += foundationLength - 1;
@@ -100,16 +206,15 @@ int Persistence::getArrayLength()
     return MAX_CARDS - omittedCount + SEP_COUNT + 1 + 2;
 }
 
-char* Persistence::writeSaveData(int saveDataLength)
+// Writes the v1 body, saveData must hold getArrayLength() bytes
+void Persistence::writeSaveData(const Board& board, char* saveData)
 {
-    // Make a new char array to store the save data
-    char* saveData = new char[saveDataLength]; // Read bottom comment for the size calculation
     int saveDataIndex = 0;
 
     for (int i = 0; i < STACK_COUNT; i++)
     {
         // Save the stack data
-        writeStackData(i, saveData, &saveDataIndex);
+        writeStackData(board, i, saveData, &saveDataIndex);
         writeSep(saveData, &saveDataIndex);
     }
 
@@ -118,39 +223,89 @@ char* Persistence::writeSaveData(int saveDataLength)
     for (int i = 0; i < FOUNDATION_COUNT; i++)
     {
         // Save the foundation data
-        writeFoundationData(i, saveData, &saveDataIndex);
+        writeFoundationData(board, i, saveData, &saveDataIndex);
     }
     writeSep(saveData, &saveDataIndex);
 
     // Save remaining unused cards count
-    saveData[saveDataIndex++] = this->board->getRemainingUnusedCardCount() & 0xFF;
+    saveData[saveDataIndex++] = board.getRemainingUnusedCardCount() & 0xFF;
 
     // Save the unused pile data
-    writeUnusedData(saveData, &saveDataIndex);
+    writeUnusedData(board, saveData, &saveDataIndex);
     writeSep(saveData, &saveDataIndex);
 
     // Clamp moves to 2 bytes
-    int moveCount = this->board->getMoves();
+    int moveCount = board.getMoves();
     saveData[saveDataIndex++] = (moveCount >> 8) & 0xFF;
     saveData[saveDataIndex++] = moveCount & 0xFF;
+}
 
-    return saveData;
+bool Persistence::readVersionedData(const char* saveData, int saveDataLength)
+{
+    int version = saveData[SAVEFILE_MAGIC_LENGTH];
+    int headerLength = version == 2 ? V2_HEADER_LENGTH : SAVEFILE_HEADER_LENGTH;
+    if ((version != 2 && version != SAVEFILE_VERSION) || saveDataLength < headerLength + 8 + V1_MIN_LENGTH)
+    {
+        return false;
+    }
+
+    int ruleVariant;
+    int redealCount = 0;
+    if (version == 2)
+    {
+        int drawCount = saveData[SAVEFILE_MAGIC_LENGTH + 1];
+        ruleVariant = drawCount == getRuleSet(RuleVariant::DRAW_THREE_RULES)->drawCount ? RuleVariant::DRAW_THREE_RULES :
+            drawCount == getRuleSet(RuleVariant::STANDARD_RULES)->drawCount ? RuleVariant::STANDARD_RULES : RULE_VARIANT_COUNT;
+    }
+    else
+    {
+        ruleVariant = static_cast<unsigned char>(saveData[SAVEFILE_MAGIC_LENGTH + 1]);
+        redealCount = static_cast<unsigned char>(saveData[SAVEFILE_MAGIC_LENGTH + 2]);
+    }
+    int saveDataIndex = headerLength - 4;
+    uint32_t checksum = readUint32(saveData, &saveDataIndex);
+    if (ruleVariant >= RULE_VARIANT_COUNT ||
+        checksum != getChecksum(saveData + headerLength, saveDataLength - headerLength))
+    {
+        return false;
+    }
+
+    uint32_t seed = readUint32(saveData, &saveDataIndex);
+    uint32_t journalLength = readUint32(saveData, &saveDataIndex);
+    int bodyLength = saveDataLength - saveDataIndex - static_cast<int>(journalLength);
+    if (journalLength > static_cast<uint32_t>(saveDataLength) || bodyLength < V1_MIN_LENGTH || bodyLength > V1_MAX_LENGTH ||
+        !this->history->decode(saveData + saveDataIndex, journalLength))
+    {
+        return false;
+    }
+    saveDataIndex += journalLength;
+
+    this->checksum = checksum;
+    this->board->setSeed(seed);
+    this->board->setRuleVariant(static_cast<RuleVariant>(ruleVariant));
+    if (!readSaveData(this->board, saveData + saveDataIndex, bodyLength))
+    {
+        return false;
+    }
+    this->board->setRedealCount(redealCount);
+    return true;
 }
 
-bool Persistence::readSaveData(char* saveData, int saveDataLength)
+bool Persistence::readSaveData(Board* board, const char* saveData, int saveDataLength)
 {
     // Split the save data into separate piles at "SEP" (We should have 9 "SEP"s, reject if not)
+    // Stop at the last one, the move count after it is binary and may itself contain 0xFF
     int sepCount = 0;
     int saveDataStartIndex = 0;
     int saveDataEndIndex = 0;
-    for (; saveDataEndIndex < saveDataLength; saveDataEndIndex++)
+    for (; saveDataEndIndex < saveDataLength && sepCount < SEP_COUNT; saveDataEndIndex++)
     {
         if (saveData[saveDataEndIndex] == -1)
         {
             // Feed the sliced save data into helper read functions
-            if (!((sepCount <= 6 && readStackData(saveData, saveDataStartIndex, saveDataEndIndex, sepCount)) || // Stacks
-                (sepCount == 7 && readFoundationData(saveData, saveDataStartIndex, saveDataEndIndex)) || // Foundations
-                (sepCount == 8 && readUnusedData(saveData, saveDataStartIndex, saveDataEndIndex)))) // Unused Pile 
+            if (!((sepCount <= 6 && readStackData(board, saveData, saveDataStartIndex, saveDataEndIndex, sepCount)) || // Stacks
+                (sepCount == 7 && readFoundationData(board, saveData, saveDataStartIndex, saveDataEndIndex)) || // Foundations
+                (sepCount == 8 && readUnusedData(board, saveData, saveDataStartIndex, saveDataEndIndex)))) // Unused Pile 
             { 
                 // Should never reach here
                 return false;
@@ -160,40 +315,51 @@ bool Persistence::readSaveData(char* saveData, int saveDataLength)
             sepCount++;
         }
     }
-    return (sepCount == SEP_COUNT && readMovesData(saveData, saveDataStartIndex)); // Moves
+    return (sepCount == SEP_COUNT && saveDataLength - saveDataStartIndex >= 2 && readMovesData(board, saveData, saveDataStartIndex)); // Moves
 }
 
-void Persistence::writeStackData(int stackIndex, char* saveData, int* saveDataIndex)
+void Persistence::writeStackData(const Board& board, int stackIndex, char* saveData, int* saveDataIndex)
 {
-    int stackLength = this->board->getStackLength(stackIndex);
+    int stackLength = board.getStackLength(stackIndex);
+    int hiddenCount = board.getHiddenCardCount(stackIndex);
     for (int i = 0; i < stackLength; i++)
     {
-        Card* card = this->board->getCardFromStack(stackIndex, i);
-        writeCardData(card, saveData, saveDataIndex);
+        Card* card = board.getCardFromStack(stackIndex, i);
+        writeCardData(card, i >= hiddenCount, saveData, saveDataIndex);
     }
 }
 
-void Persistence::writeFoundationData(int suitIndex, char* saveData, int* saveDataIndex)
+void Persistence::writeFoundationData(const Board& board, int suitIndex, char* saveData, int* saveDataIndex)
 {
     // Basically just find the topmost visible card in the foundation and save it
-    int foundationLength = this->board->getFoundationLength(suitIndex);
+    int foundationLength = board.getFoundationLength(suitIndex);
     if (foundationLength > 0)
     {
-        Card* card = this->board->getCardFromFoundation(suitIndex, foundationLength - 1);
-        writeCardData(card, saveData, saveDataIndex);
+        Card* card = board.getCardFromFoundation(suitIndex, foundationLength - 1);
+        writeCardData(card, true, saveData, saveDataIndex);
     }
     // No need to save empty foundation piles since we already encode the suit in the foundation data
 }
 
-void Persistence::writeUnusedData(char* saveData, int* saveDataIndex)
+void Persistence::writeUnusedData(const Board& board, char* saveData, int* saveDataIndex)
 {
-    Card* currCard = this->board->getCurrentUnusedCard();
-    Card* savedCard = currCard;
-    do {
-        writeCardData(currCard, saveData, saveDataIndex);
-        currCard = this->board->shiftNextUnusedCard();
+    // Written as if the unused pile was dealt one card at a time, starting from the current card:
+    // Top of the waste, then the stock in draw order, then the rest of the waste from the bottom
+    int wasteLength = board.getWasteLength();
+    int stockLength = board.getRemainingUnusedCardCount();
+
+    if (wasteLength > 0)
+    {
+        writeCardData(board.getCardFromWaste(wasteLength - 1), true, saveData, saveDataIndex);
+    }
+    for (int i = 0; i < stockLength; i++)
+    {
+        writeCardData(board.getCardFromStock(i), false, saveData, saveDataIndex);
+    }
+    for (int i = 0; i < wasteLength - 1; i++)
+    {
+        writeCardData(board.getCardFromWaste(i), false, saveData, saveDataIndex);
     }
-    while (currCard != savedCard);
 }
 
 void Persistence::writeSep(char* saveData, int* saveDataIndex)
@@ -202,15 +368,15 @@ void Persistence::writeSep(char* saveData, int* saveDataIndex)
     *saveDataIndex += 1;
 }
 
-void Persistence::writeCardData(Card* card, char* saveData, int* saveDataIndex)
+void Persistence::writeCardData(const Card* card, bool isFaceUp, char* saveData, int* saveDataIndex)
 {
     // Save the card data
     if (card == nullptr)
     {
         return;
     }
-    int cardData = static_cast<int>(card->suit) * MAX_VALUE + card->value - 1;
-    if (card->isFaceUp)
+    int cardData = getCardId(card);
+    if (isFaceUp)
     {
         saveData[*saveDataIndex] = cardData;
     }
@@ -221,46 +387,58 @@ void Persistence::writeCardData(Card* card, char* saveData, int* saveDataIndex)
     *saveDataIndex += 1;
 }
 
-bool Persistence::readStackData(char* saveData, int saveDataStartIndex, int saveDataEndIndex, int stackIndex)
+bool Persistence::readStackData(Board* board, const char* saveData, int saveDataStartIndex, int saveDataEndIndex, int stackIndex)
 {
     int stackLength = saveDataEndIndex - saveDataStartIndex; // endIndex is exclusive
     for (int i = 0; i < stackLength; i++)
     {
-        Card* card = readCardData(saveData[saveDataStartIndex + i]);
-        bool isFaceUp = card->isFaceUp;
-        if (card == nullptr)
+        bool isFaceUp;
+        Card* card = readCardData(saveData[saveDataStartIndex + i], &isFaceUp);
+        if (card == nullptr || board->getStackLength(stackIndex) >= MAX_STACK_LENGTH)
+        {
+            return false;
+        }
+
+        if (isFaceUp)
+        {
+            board->addCardToStack(stackIndex, card);
+        }
+        else if (board->getStackLength(stackIndex) == board->getHiddenCardCount(stackIndex))
+        {
+            board->addHiddenCardToStack(stackIndex, card);
+        }
+        else // Face down cards must be at the bottom of the stack
         {
             return false;
         }
-        this->board->addCardToStack(stackIndex, card);
-        card->isFaceUp = isFaceUp; // Since board addCardToStack sets it to true
     }
     return true;
 }
 
-bool Persistence::readFoundationData(char* saveData, int saveDataStartIndex, int saveDataEndIndex)
+bool Persistence::readFoundationData(Board* board, const char* saveData, int saveDataStartIndex, int saveDataEndIndex)
 {
     int foundationCount = saveDataEndIndex - saveDataStartIndex; // endIndex is exclusive
     for (int i = 0; i < foundationCount; i++)
     {
-        Card* card = readCardData(saveData[saveDataStartIndex + i]);
-        if (card == nullptr)
+        bool isFaceUp;
+        Card* card = readCardData(saveData[saveDataStartIndex + i], &isFaceUp);
+        if (card == nullptr || board->getFoundationLength(card->suit) > 0)
         {
             return false;
         }
 
         int cardValue = card->value;
-        char initSuitData = static_cast<char>(card->suit) * MAX_VALUE;
+        int initSuitData = static_cast<int>(card->suit) * MAX_VALUE;
         for (int j = 0; j < cardValue; j++)
         {
-            Card* newCard = this->deck[initSuitData + j];
-            this->board->addCardToFoundation(card->suit, newCard);
+            Card* newCard = &DECK[initSuitData + j];
+            board->addCardToFoundation(card->suit, newCard);
         }
     }
     return true;
 }
 
-bool Persistence::readUnusedData(char* saveData, int saveDataStartIndex, int saveDataEndIndex)
+bool Persistence::readUnusedData(Board* board, const char* saveData, int saveDataStartIndex, int saveDataEndIndex)
 {
     int unusedCardsRemaining = saveData[saveDataStartIndex]; // 1byte
     saveDataStartIndex += 1;
@@ -270,8 +448,12 @@ bool Persistence::readUnusedData(char* saveData, int saveDataStartIndex, int sav
     {
         return true;
     }
+    if (unusedCardsRemaining < 0 || unusedCardsRemaining > unusedCardCount || unusedCardCount > RESERVED_CARDS)
+    {
+        return false;
+    }
 
-    Card* unusedCards[unusedCardCount];
+    Card* unusedCards[RESERVED_CARDS];
     // 0 + 23 = 24 - 1 -> remainingCards + currUnusedIndex = unusedCardCount - 1
     int currUnusedIndex = unusedCardCount - unusedCardsRemaining - 1;
 
@@ -295,7 +477,8 @@ bool Persistence::readUnusedData(char* saveData, int saveDataStartIndex, int sav
     do
     {
         int byteIndex = saveDataStartIndex + currBuffer;
-        Card* card = readCardData(saveData[byteIndex]);
+        bool isFaceUp;
+        Card* card = readCardData(saveData[byteIndex], &isFaceUp);
         if (card == nullptr)
         {
             return false;
@@ -307,23 +490,23 @@ bool Persistence::readUnusedData(char* saveData, int saveDataStartIndex, int sav
     while (currBuffer != initBuffer);
 
     // Then we add the cards to the unused Pile
-    return this->board->loadUnusedCards(unusedCards, unusedCardCount, currUnusedIndex);
+    return board->loadUnusedCards(unusedCards, unusedCardCount, currUnusedIndex);
 }
 
-bool Persistence::readMovesData(char* saveData, int saveDataStartIndex)
+bool Persistence::readMovesData(Board* board, const char* saveData, int saveDataStartIndex)
 {
     int moveCount = (static_cast<unsigned char>(saveData[saveDataStartIndex]) << 8) | static_cast<unsigned char>(saveData[saveDataStartIndex + 1]);
-    while (this->board->getMoves() < moveCount)
+    while (board->getMoves() < moveCount)
     {
-        this->board->addMoves();
+        board->addMoves();
     }
     return true;
 }
 
-Card* Persistence::readCardData(char cardData)
+Card* Persistence::readCardData(char cardData, bool* isFaceUp)
 {
-    bool isFaceUp = cardData >= 0;
-    if (!isFaceUp)
+    *isFaceUp = cardData >= 0;
+    if (!*isFaceUp)
     {
         cardData -= 128;
     }
@@ -335,11 +518,110 @@ Card* Persistence::readCardData(char cardData)
     }
 
     // Find this card in the deck
-    Card* card = this->deck[static_cast<int>(cardData)];
-    if (card == nullptr)
+    return &DECK[static_cast<int>(cardData)];
+}
+
+bool Persistence::hasMagic(const char* saveData, int saveDataLength)
+{
+    if (saveDataLength < SAVEFILE_MAGIC_LENGTH)
     {
-        return nullptr;
+        return false;
+    }
+    for (int i = 0; i < SAVEFILE_MAGIC_LENGTH; i++)
+    {
+        if (saveData[i] != SAVEFILE_MAGIC[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Persistence::writeUint32(uint32_t value, char* saveData, int* saveDataIndex)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+    {
+        saveData[*saveDataIndex] = (value >> shift) & 0xFF;
+        *saveDataIndex += 1;
+    }
+}
+
+uint32_t Persistence::readUint32(const char* saveData, int* saveDataIndex)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        value = (value << 8) | static_cast<unsigned char>(saveData[*saveDataIndex]);
+        *saveDataIndex += 1;
+    }
+    return value;
+}
+
+struct ChecksumTable
+{
+    uint32_t entries[256];
+};
+
+static ChecksumTable makeChecksumTable()
+{
+    ChecksumTable table;
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        uint32_t crc = i;
+        for (int j = 0; j < 8; j++)
+        {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+        }
+        table.entries[i] = crc;
+    }
+    return table;
+}
+
+// CRC32 (IEEE 802.3), one table lookup per byte
+// Saves are checksummed on the save workers as well as the input thread, a function local static is filled exactly once
+uint32_t Persistence::getChecksum(const char* data, int dataLength)
+{
+    static const ChecksumTable table = makeChecksumTable();
+
+    uint32_t crc = 0xFFFFFFFF;
+    for (int i = 0; i < dataLength; i++)
+    {
+        crc = table.entries[(crc ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFF;
+}
+
+bool Persistence::syncFile(FILE* file)
+{
+    if (fflush(file) != 0)
+    {
+        return false;
+    }
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+// Atomically replaces fileName with tempName, once tempName is on disk
+bool Persistence::replaceFile(const char* tempName, const char* fileName)
+{
+    FILE* tempFile = fopen(tempName, "r+b");
+    bool isSynced = tempFile != nullptr && syncFile(tempFile);
+    if (tempFile != nullptr)
+    {
+        fclose(tempFile);
+    }
+    if (!isSynced)
+    {
+        return false;
+    }
+
+    if (WINDOWS)
+    {
+        // Windows does not rename over an existing file
+        remove(fileName);
     }
-    card->isFaceUp = isFaceUp;
-    return card;
+    return rename(tempName, fileName) == 0;
 }
\ No newline at end of file
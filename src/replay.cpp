@@ -0,0 +1,213 @@
+#include "replay.hpp"
+
+static int parsePile(char pileChar)
+{
+    if (pileChar >= '1' && pileChar < '1' + STACK_COUNT)
+    {
+        return FIRST_STACK_PILE + pileChar - '1';
+    }
+    for (int i = 0; i < FOUNDATION_COUNT; i++)
+    {
+        if (pileChar == FOUNDATION_NOTATION[i])
+        {
+            return FIRST_FOUNDATION_PILE + i;
+        }
+    }
+    return pileChar == 'w' ? UNUSED_PILE : -1;
+}
+
+static char getPileChar(int pile)
+{
+    if (isStackPile(pile))
+    {
+        return '1' + pile - FIRST_STACK_PILE;
+    }
+    return isFoundationPile(pile) ? FOUNDATION_NOTATION[pile - FIRST_FOUNDATION_PILE] : 'w';
+}
+
+// Only checks the notation, whether the move is legal is up to the position
+bool parseMove(const string& text, Move* move)
+{
+    if (text == "s")
+    {
+        *move = { UNUSED_PILE, UNUSED_PILE, 1 };
+        return true;
+    }
+    if (text.length() < 2)
+    {
+        return false;
+    }
+
+    int from = parsePile(text[0]);
+    int to = parsePile(text[1]);
+    if (from < 0 || to < 0 || to == UNUSED_PILE || from == to || (isFoundationPile(from) && !isStackPile(to)))
+    {
+        return false;
+    }
+
+    int count = 1;
+    if (text.length() > 2)
+    {
+        // Only stack to stack moves take more than one card
+        if (text[2] != 'x' || !isStackPile(from) || !isStackPile(to) || text.length() > 5)
+        {
+            return false;
+        }
+        count = 0;
+        for (size_t i = 3; i < text.length(); i++)
+        {
+            if (text[i] < '0' || text[i] > '9')
+            {
+                return false;
+            }
+            count = count * 10 + text[i] - '0';
+        }
+        if (count < 1 || count > MAX_STACK_LENGTH)
+        {
+            return false;
+        }
+    }
+
+    *move = { static_cast<uint8_t>(from), static_cast<uint8_t>(to), static_cast<uint8_t>(count) };
+    return true;
+}
+
+string formatMove(const Move& move)
+{
+    if (move.from == UNUSED_PILE && move.to == UNUSED_PILE)
+    {
+        return "s";
+    }
+
+    string text = { getPileChar(move.from), getPileChar(move.to) };
+    if (move.count > 1)
+    {
+        text += "x" + std::to_string(move.count);
+    }
+    return text;
+}
+
+static string describePile(int pile)
+{
+    const char* FOUNDATION_NAMES[FOUNDATION_COUNT] = { "Diamonds", "Clubs", "Hearts", "Spades" };
+    if (isStackPile(pile))
+    {
+        return "Stack " + std::to_string(pile - FIRST_STACK_PILE + 1);
+    }
+    return isFoundationPile(pile) ? FOUNDATION_NAMES[pile - FIRST_FOUNDATION_PILE] : "Waste";
+}
+
+string describeMove(const Move& move)
+{
+    if (move.from == UNUSED_PILE && move.to == UNUSED_PILE)
+    {
+        return "Draw from the Stock";
+    }
+
+    string text = describePile(move.from) + " to " + describePile(move.to);
+    if (move.count > 1)
+    {
+        text = std::to_string(move.count) + " cards from " + text;
+    }
+    return text;
+}
+
+string formatCard(const Card* card)
+{
+    string text = { "A23456789TJQK"[card->value - 1], FOUNDATION_NOTATION[card->suit] };
+    return text;
+}
+
+string formatBoard(const Board& board)
+{
+    string text = std::to_string(board.getMoves()) + " " + std::to_string(board.getRemainingUnusedCardCount()) + " ";
+    text += board.getCurrentUnusedCard() != nullptr ? formatCard(board.getCurrentUnusedCard()) : "-";
+    for (int i = 0; i < FOUNDATION_COUNT; i++)
+    {
+        text += " " + std::to_string(board.getFoundationLength(i));
+    }
+    for (int i = 0; i < STACK_COUNT; i++)
+    {
+        text += " ";
+        if (board.getStackLength(i) == 0)
+        {
+            text += "-";
+        }
+        for (int j = 0; j < board.getStackLength(i); j++)
+        {
+            text += j < board.getHiddenCardCount(i) ? "##" : formatCard(board.getCardFromStack(i, j));
+        }
+    }
+    return text;
+}
+
+Replay::Replay() : logic(&this->board, nullptr, nullptr, nullptr)
+{
+}
+
+ReplayResult Replay::run(uint32_t seed, RuleVariant variant, const Move* moves, int moveCount)
+{
+    deal(seed, variant);
+    for (int i = 0; i < moveCount; i++)
+    {
+        if (!this->logic.applyMove(moves[i]))
+        {
+            return getResult(i, i);
+        }
+    }
+    return getResult(-1, moveCount);
+}
+
+// Decodes the moves on the fly, a move that can not be decoded is illegal too
+ReplayResult Replay::runEncoded(uint32_t seed, RuleVariant variant, const char* data, int dataLength)
+{
+    deal(seed, variant);
+    int moveIndex = 0;
+    int dataIndex = 0;
+    while (dataIndex < dataLength)
+    {
+        Move move;
+        int moveLength = MoveHistory::decodeMove(data + dataIndex, dataLength - dataIndex, &move);
+        if (moveLength == 0 || !this->logic.applyMove(move))
+        {
+            return getResult(moveIndex, moveIndex);
+        }
+        dataIndex += moveLength;
+        moveIndex++;
+    }
+    return getResult(-1, moveIndex);
+}
+
+const Board* Replay::getBoard()
+{
+    return &this->board;
+}
+
+// The moves that follow are checked against the rules of the variant
+void Replay::deal(uint32_t seed, RuleVariant variant)
+{
+    this->board.onNewGame();
+    this->board.setRuleVariant(variant);
+    this->board.dealCards(seed);
+}
+
+int Replay::generateMoves(Move* moves)
+{
+    return this->logic.generateMoves(moves);
+}
+
+bool Replay::applyMove(const Move& move)
+{
+    return this->logic.applyMove(move);
+}
+
+bool Replay::isGameWon()
+{
+    return this->logic.isGameWon();
+}
+
+ReplayResult Replay::getResult(int illegalMoveIndex, int appliedMoveCount)
+{
+    ReplayResult result = { illegalMoveIndex, appliedMoveCount, this->logic.isGameWon() };
+    return result;
+}
@@ -0,0 +1,114 @@
+#include "replayviewer.hpp"
+#include "replay.hpp"
+#include "display.hpp"
+
+ReplayViewer::ReplayViewer()
+{
+    this->isPlaying = false;
+    this->speedIndex = REPLAY_DEFAULT_SPEED;
+}
+
+// Starts at the deal, returns the number of legal moves that were loaded
+int ReplayViewer::load(uint32_t seed, RuleVariant variant, const Move* moves, int moveCount)
+{
+    int loadedCount = this->timeline.load(seed, variant, moves, moveCount);
+    this->isPlaying = false;
+    this->timeline.seek(0);
+    return loadedCount;
+}
+
+void ReplayViewer::step(bool isForward)
+{
+    this->isPlaying = false;
+    this->timeline.seek(this->timeline.getPosition() + (isForward ? 1 : -1));
+}
+
+void ReplayViewer::seekPage(bool isForward)
+{
+    int pageLength = this->timeline.getLength() / REPLAY_SEEK_DIVISOR;
+    if (pageLength < KEYFRAME_INTERVAL)
+    {
+        pageLength = KEYFRAME_INTERVAL;
+    }
+    this->timeline.seek(this->timeline.getPosition() + (isForward ? pageLength : -pageLength));
+}
+
+void ReplayViewer::seekEnd(bool isForward)
+{
+    this->timeline.seek(isForward ? this->timeline.getLength() : 0);
+}
+
+void ReplayViewer::togglePlaying()
+{
+    if (!this->isPlaying && this->timeline.getPosition() == this->timeline.getLength())
+    {
+        // Play again from the start
+        this->timeline.seek(0);
+    }
+    this->isPlaying = !this->isPlaying;
+    this->nextStepTime = std::chrono::steady_clock::now() + std::chrono::milliseconds(REPLAY_STEP_DELAYS_MS[this->speedIndex]);
+}
+
+void ReplayViewer::shiftSpeed(bool isFaster)
+{
+    if (isFaster && this->speedIndex < REPLAY_SPEED_COUNT - 1)
+    {
+        this->speedIndex++;
+    }
+    else if (!isFaster && this->speedIndex > 0)
+    {
+        this->speedIndex--;
+    }
+}
+
+// Plays the moves that are due
+void ReplayViewer::update()
+{
+    if (!this->isPlaying)
+    {
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    int position = this->timeline.getPosition();
+    while (this->nextStepTime <= now && position < this->timeline.getLength())
+    {
+        position++;
+        this->nextStepTime += std::chrono::milliseconds(REPLAY_STEP_DELAYS_MS[this->speedIndex]);
+    }
+    this->timeline.seek(position);
+
+    if (position == this->timeline.getLength())
+    {
+        this->isPlaying = false;
+    }
+}
+
+// The status goes on the message row y
+void ReplayViewer::render(int y)
+{
+    int position = this->timeline.getPosition();
+    string message = "Replay  Move " + std::to_string(position) + "/" + std::to_string(this->timeline.getLength());
+    if (position > 0)
+    {
+        message += "  " + formatMove(this->timeline.getMove(position - 1));
+    }
+    message += this->isPlaying ? "  Playing " + std::to_string(REPLAY_STEP_DELAYS_MS[this->speedIndex]) + "ms/move" : "  Paused";
+    monoColorPrint(ColorPair::MAGENTA, y, MSG_STARTING_X, message);
+}
+
+int ReplayViewer::getStepDelay()
+{
+    if (!this->isPlaying)
+    {
+        return -1;
+    }
+
+    auto delay = std::chrono::duration_cast<std::chrono::milliseconds>(this->nextStepTime - std::chrono::steady_clock::now());
+    return delay.count() > 0 ? static_cast<int>(delay.count()) : 0;
+}
+
+Board* ReplayViewer::getBoard()
+{
+    return this->timeline.getBoard();
+}
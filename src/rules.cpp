@@ -0,0 +1,326 @@
+#include "rules.hpp"
+
+// Validates and applies moves under one rule policy, every rule check is resolved at compile time
+template <class Rules>
+class MoveValidator
+{
+public:
+    static bool applyMove(Board*, const Move&);
+    static int generateMoves(Board*, Bitboard*, Move*);
+
+private:
+    static bool drawUnusedCards(Board*);
+    static bool stackToStack(Board*, int, int, int);
+    static bool stackToFoundation(Board*, int);
+    static bool unusedToStack(Board*, int);
+    static bool unusedToFoundation(Board*);
+    static bool foundationToStack(Board*, int, int);
+
+    static bool canExistingStackAcceptCard(Card*, Card*);
+    static bool canEmptyStackAcceptCard(Card*);
+
+    static bool canEmptyFoundationAcceptCard(Card*);
+    static bool canExistingFoundationAcceptCard(Card*, Card*);
+};
+
+template <class Rules>
+bool MoveValidator<Rules>::applyMove(Board* board, const Move& move)
+{
+    if (move.from == UNUSED_PILE)
+    {
+        if (move.to == UNUSED_PILE)
+        {
+            return drawUnusedCards(board);
+        }
+        else if (isStackPile(move.to))
+        {
+            return unusedToStack(board, move.to - FIRST_STACK_PILE);
+        }
+        Card* card = board->getCurrentUnusedCard();
+        return card != nullptr && move.to == FIRST_FOUNDATION_PILE + card->suit && unusedToFoundation(board);
+    }
+    else if (isStackPile(move.from))
+    {
+        int fromStackIndex = move.from - FIRST_STACK_PILE;
+        int stackLength = board->getStackLength(fromStackIndex);
+        if (isStackPile(move.to))
+        {
+            return move.from != move.to && move.count >= 1 && move.count <= stackLength &&
+                stackToStack(board, stackLength - move.count, fromStackIndex, move.to - FIRST_STACK_PILE);
+        }
+        else if (isFoundationPile(move.to) && stackLength > 0)
+        {
+            Card* card = board->getCardFromStack(fromStackIndex, stackLength - 1);
+            return move.to == FIRST_FOUNDATION_PILE + card->suit && stackToFoundation(board, fromStackIndex);
+        }
+    }
+    else if (Rules::CAN_MOVE_FROM_FOUNDATION && isFoundationPile(move.from) && isStackPile(move.to))
+    {
+        return foundationToStack(board, move.from - FIRST_FOUNDATION_PILE, move.to - FIRST_STACK_PILE);
+    }
+    return false;
+}
+
+template <class Rules>
+int MoveValidator<Rules>::generateMoves(Board* board, Bitboard* bitboard, Move* moves)
+{
+    bitboard->update(board);
+    return bitboard->template generateMoves<Rules>(moves);
+}
+
+template <class Rules>
+bool MoveValidator<Rules>::drawUnusedCards(Board* board)
+{
+    if (board->getNextUnusedCard() == nullptr && (board->getCurrentUnusedCard() == nullptr || !canRedeal<Rules>(board->getRedealCount())))
+    {
+        return false;
+    }
+
+    board->shiftNextUnusedCard();
+    return true;
+}
+
+// Move cards from one stack to another stack
+// We can use enum to represent the return values and tell the player what went wrong
+template <class Rules>
+bool MoveValidator<Rules>::stackToStack(Board* board, int cardIndex, int fromStackIndex, int toStackIndex)
+{
+    // Get the stack length
+    int fromStackLength = board->getStackLength(fromStackIndex);
+    if (cardIndex >= fromStackLength)
+    {
+        return false;
+    }
+
+    // If any of the cards are face down, then we can't move them
+    if (cardIndex < board->getHiddenCardCount(fromStackIndex))
+    {
+        return false;
+    }
+
+    // Get the cards that will be moved from the stack
+    // Example: If the stack has 5 cards and the cardIndex is 2, then 3 cards will be moved (2, 3, 4)
+    int numCardsToMove = fromStackLength - cardIndex;
+    Card* cardsToMove[MAX_STACK_LENGTH];
+    for (int i = 0; i < numCardsToMove; ++i)
+    {
+        cardsToMove[i] = board->getCardFromStack(fromStackIndex, cardIndex + i);
+    }
+
+    // If toStack is empty, then only the cards the rules allow can start it
+    if (board->getStackLength(toStackIndex) == 0)
+    {
+        if (canEmptyStackAcceptCard(cardsToMove[0]) == false)
+        {
+            return false;
+        }
+    }
+    else
+    {
+        // If toStack is not empty, then we can move only cards that are in descending order and alternate colors
+        Card* toTopCard = board->getCardFromStack(toStackIndex, board->getStackLength(toStackIndex) - 1);
+        if (canExistingStackAcceptCard(toTopCard, cardsToMove[0]) == false)
+        {
+            return false;
+        }
+    }
+
+    // Move the cards to the stack
+    for (int i = 0; i < numCardsToMove; i++)
+    {
+        board->removeCardFromStack(fromStackIndex);
+        board->addCardToStack(toStackIndex, cardsToMove[i]);
+    }
+    return true;
+}
+
+template <class Rules>
+bool MoveValidator<Rules>::stackToFoundation(Board* board, int stackIndex)
+{
+    bool hasTransferredCard = false;
+
+    // Only the cards that are face up now can be moved, even if removing them flips the card below
+    int hiddenCount = board->getHiddenCardCount(stackIndex);
+
+    while (true)
+    {
+        // Get the stack length
+        int stackLength = board->getStackLength(stackIndex);
+        if (stackLength <= hiddenCount)
+        {
+            break;
+        }
+
+        // Get the card that will be moved from the stack
+        Card* card = board->getCardFromStack(stackIndex, stackLength - 1);
+
+        // Get suit of the card
+        int cardSuit = static_cast<int>(card->suit);
+        int foundationLength = board->getFoundationLength(cardSuit);
+        if (foundationLength == 0)
+        {
+            // If the foundation is empty, then we can move only Ace-cards
+            if (canEmptyFoundationAcceptCard(card) == false)
+            {
+                break;
+            }
+        }
+        else
+        {
+            // If the foundation is not empty, then we can move only cards that are in ascending order and same suit
+            Card* foundationTopCard = board->getCardFromFoundation(cardSuit, foundationLength - 1);
+            if (canExistingFoundationAcceptCard(foundationTopCard, card) == false)
+            {
+                break;
+            }
+        }
+
+        // Move the card to the foundation
+        board->removeCardFromStack(stackIndex);
+        board->addCardToFoundation(cardSuit, card);
+        hasTransferredCard = true;
+    }
+
+    // The whole chain counts as 1 move
+    return hasTransferredCard;
+}
+
+template <class Rules>
+bool MoveValidator<Rules>::unusedToStack(Board* board, int stackIndex)
+{
+    // Get the card that will be moved from the unused cards
+    Card* card = board->getCurrentUnusedCard();
+    if (card == nullptr)
+    {
+        return false;
+    }
+
+    // Get the stack length
+    int stackLength = board->getStackLength(stackIndex);
+
+    // Check the last card in the stack and see if it is compatible
+    if (stackLength > 0)
+    {
+        Card* toTopCard = board->getCardFromStack(stackIndex, stackLength - 1);
+        if (toTopCard == nullptr || !canExistingStackAcceptCard(toTopCard, card))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        if (!canEmptyStackAcceptCard(card))
+        {
+            return false;
+        }
+    }
+
+    // Move the card to the stack
+    board->removeUnusedCard();
+    board->addCardToStack(stackIndex, card);
+    return true;
+}
+
+template <class Rules>
+bool MoveValidator<Rules>::unusedToFoundation(Board* board)
+{
+    // Get the card that will be moved from the unused cards
+    Card* card = board->getCurrentUnusedCard();
+    if (card == nullptr)
+    {
+        return false;
+    }
+
+    // Get suit of the card
+    int cardSuit = static_cast<int>(card->suit);
+    int foundationLength = board->getFoundationLength(cardSuit);
+    if (foundationLength == 0)
+    {
+        // If the foundation is empty, then we can move only Ace-cards
+        if (canEmptyFoundationAcceptCard(card) == false)
+        {
+            return false;
+        }
+    }
+    else
+    {
+        // If the foundation is not empty, then we can move only cards that are in ascending order and same suit
+        Card* foundationTopCard = board->getCardFromFoundation(cardSuit, foundationLength - 1);
+        if (canExistingFoundationAcceptCard(foundationTopCard, card) == false)
+        {
+            return false;
+        }
+    }
+
+    // Move the card to the foundation
+    board->removeUnusedCard();
+    board->addCardToFoundation(cardSuit, card);
+    return true;
+}
+
+template <class Rules>
+bool MoveValidator<Rules>::foundationToStack(Board* board, int foundationIndex, int stackIndex)
+{
+    // Get the stack length
+    int stackLength = board->getStackLength(stackIndex);
+    if (stackLength == 0)
+    {
+        return false;
+    }
+
+    // Get the card that will be moved from the foundation
+    if (foundationIndex < 0 || foundationIndex >= FOUNDATION_COUNT || board->getFoundationLength(foundationIndex) == 0)
+    {
+        return false;
+    }
+    Card* card = board->getCardFromFoundation(foundationIndex, board->getFoundationLength(foundationIndex) - 1);
+
+    // The stack is not empty, so we can move only cards that are in descending order and alternate colors
+    Card* toTopCard = board->getCardFromStack(stackIndex, stackLength - 1);
+    if (canExistingStackAcceptCard(toTopCard, card) == false)
+    {
+        return false;
+    }
+
+    // Move the card to the stack
+    board->removeCardFromFoundation(foundationIndex);
+    board->addCardToStack(stackIndex, card);
+    return true;
+}
+
+template <class Rules>
+bool MoveValidator<Rules>::canExistingStackAcceptCard(Card* toCard, Card* fromCard)
+{
+    return (TABLEAU_ACCEPTORS[getCardId(fromCard)] & cardBit(getCardId(toCard))) != 0;
+}
+
+template <class Rules>
+bool MoveValidator<Rules>::canEmptyStackAcceptCard(Card* card)
+{
+    return (Rules::EMPTY_STACK_CARDS & cardBit(getCardId(card))) != 0;
+}
+
+template <class Rules>
+bool MoveValidator<Rules>::canEmptyFoundationAcceptCard(Card* card)
+{
+    return (ACE_CARDS & cardBit(getCardId(card))) != 0;
+}
+
+template <class Rules>
+bool MoveValidator<Rules>::canExistingFoundationAcceptCard(Card* toCard, Card* fromCard)
+{
+    return (FOUNDATION_ACCEPTORS[getCardId(fromCard)] & cardBit(getCardId(toCard))) != 0;
+}
+
+// In RuleVariant order
+static const RuleSet RULE_SETS[RULE_VARIANT_COUNT] = {
+    { StandardRules::DRAW_COUNT, MoveValidator<StandardRules>::applyMove, MoveValidator<StandardRules>::generateMoves },
+    { DrawThreeRules::DRAW_COUNT, MoveValidator<DrawThreeRules>::applyMove, MoveValidator<DrawThreeRules>::generateMoves },
+    { VegasRules::DRAW_COUNT, MoveValidator<VegasRules>::applyMove, MoveValidator<VegasRules>::generateMoves },
+    { VegasDrawThreeRules::DRAW_COUNT, MoveValidator<VegasDrawThreeRules>::applyMove, MoveValidator<VegasDrawThreeRules>::generateMoves }
+};
+
+const RuleSet* getRuleSet(RuleVariant variant)
+{
+    return &RULE_SETS[variant];
+}
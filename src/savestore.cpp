@@ -0,0 +1,191 @@
+#include "savestore.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+constexpr char SAVESTORE_MAGIC[4] = { 'S', 'O', 'L', 'S' };
+constexpr int SAVESTORE_LENGTH = sizeof(SaveStoreHeader) + (sizeof(SaveSlotInfo) + SAVE_RECORD_LENGTH) * SAVE_SLOT_COUNT;
+
+SaveStore::SaveStore()
+{
+#ifndef _WIN32
+    this->fileDescriptor = -1;
+#endif
+}
+
+SaveStore::~SaveStore()
+{
+    close();
+}
+
+// Maps the store, creating it if it does not exist yet and canCreate is set
+bool SaveStore::open(bool canCreate)
+{
+    if (getIsOpen())
+    {
+        return true;
+    }
+
+#ifdef _WIN32
+    std::fstream storeFile(SAVESTORE_NAME, std::ios::binary | std::ios::in | std::ios::out);
+    if (!storeFile.is_open() && canCreate)
+    {
+        // Create it, a new store is all zeros
+        std::ofstream(SAVESTORE_NAME, std::ios::binary).close();
+        storeFile.open(SAVESTORE_NAME, std::ios::binary | std::ios::in | std::ios::out);
+    }
+    if (!storeFile.is_open())
+    {
+        return false;
+    }
+
+    this->buffer.assign(SAVESTORE_LENGTH, 0);
+    storeFile.read(this->buffer.data(), SAVESTORE_LENGTH);
+    this->data = this->buffer.data();
+#else
+    this->fileDescriptor = ::open(SAVESTORE_NAME, canCreate ? O_RDWR | O_CREAT : O_RDWR, 0644);
+    if (this->fileDescriptor < 0)
+    {
+        return false;
+    }
+
+    // A new store is all zeros, which are empty slots
+    struct stat fileStat;
+    if (fstat(this->fileDescriptor, &fileStat) != 0 ||
+        (fileStat.st_size < SAVESTORE_LENGTH && ftruncate(this->fileDescriptor, SAVESTORE_LENGTH) != 0))
+    {
+        close();
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, SAVESTORE_LENGTH, PROT_READ | PROT_WRITE, MAP_SHARED, this->fileDescriptor, 0);
+    if (mapping == MAP_FAILED)
+    {
+        close();
+        return false;
+    }
+    this->data = static_cast<char*>(mapping);
+#endif
+
+    SaveStoreHeader* header = reinterpret_cast<SaveStoreHeader*>(this->data);
+    if (header->version == 0)
+    {
+        memcpy(header->magic, SAVESTORE_MAGIC, sizeof(SAVESTORE_MAGIC));
+        header->version = SAVESTORE_VERSION;
+        header->slotCount = SAVE_SLOT_COUNT;
+        header->recordLength = SAVE_RECORD_LENGTH;
+    }
+    else if (memcmp(header->magic, SAVESTORE_MAGIC, sizeof(SAVESTORE_MAGIC)) != 0 || header->version != SAVESTORE_VERSION ||
+        header->slotCount != SAVE_SLOT_COUNT || header->recordLength != SAVE_RECORD_LENGTH)
+    {
+        // Not a store we can read, leave the file as it is
+        close();
+        return false;
+    }
+
+    this->slotInfos = reinterpret_cast<SaveSlotInfo*>(this->data + sizeof(SaveStoreHeader));
+    this->records = this->data + sizeof(SaveStoreHeader) + sizeof(SaveSlotInfo) * SAVE_SLOT_COUNT;
+    return true;
+}
+
+bool SaveStore::getIsOpen()
+{
+    return this->data != nullptr;
+}
+
+// nullptr if the slot does not exist
+const SaveSlotInfo* SaveStore::getSlotInfo(int slotIndex)
+{
+    if (!getIsOpen() || slotIndex < 0 || slotIndex >= SAVE_SLOT_COUNT)
+    {
+        return nullptr;
+    }
+    return &this->slotInfos[slotIndex];
+}
+
+bool SaveStore::saveSlot(int slotIndex, const Board& board)
+{
+    if (getSlotInfo(slotIndex) == nullptr)
+    {
+        return false;
+    }
+
+    SaveSlotInfo* slotInfo = &this->slotInfos[slotIndex];
+    slotInfo->recordLength = Persistence::writeRecord(board, this->records + slotIndex * SAVE_RECORD_LENGTH);
+    slotInfo->seed = board.getSeed();
+    slotInfo->moves = board.getMoves() & 0xFFFF;
+    slotInfo->ruleVariant = board.getRuleVariant();
+    slotInfo->redealCount = std::min(board.getRedealCount(), 0xFF);
+    slotInfo->timestamp = static_cast<int64_t>(time(nullptr));
+    return syncSlot(slotIndex);
+}
+
+bool SaveStore::loadSlot(int slotIndex, Board* board)
+{
+    const SaveSlotInfo* slotInfo = getSlotInfo(slotIndex);
+    if (slotInfo == nullptr || slotInfo->timestamp == 0 || slotInfo->ruleVariant >= RULE_VARIANT_COUNT)
+    {
+        return false;
+    }
+
+    board->setSeed(slotInfo->seed);
+    board->setRuleVariant(static_cast<RuleVariant>(slotInfo->ruleVariant));
+    if (!Persistence::readRecord(board, this->records + slotIndex * SAVE_RECORD_LENGTH, slotInfo->recordLength))
+    {
+        return false;
+    }
+    board->setRedealCount(slotInfo->redealCount);
+    return true;
+}
+
+void SaveStore::close()
+{
+#ifdef _WIN32
+    this->buffer.clear();
+#else
+    if (this->data != nullptr)
+    {
+        munmap(this->data, SAVESTORE_LENGTH);
+    }
+    if (this->fileDescriptor >= 0)
+    {
+        ::close(this->fileDescriptor);
+        this->fileDescriptor = -1;
+    }
+#endif
+    this->data = nullptr;
+    this->slotInfos = nullptr;
+    this->records = nullptr;
+}
+
+// Starts writing the slot back without waiting for the disk
+bool SaveStore::syncSlot(int slotIndex)
+{
+#ifdef _WIN32
+    std::fstream storeFile(SAVESTORE_NAME, std::ios::binary | std::ios::in | std::ios::out);
+    if (!storeFile.is_open())
+    {
+        return false;
+    }
+    storeFile.write(this->data, sizeof(SaveStoreHeader));
+    storeFile.seekp(sizeof(SaveStoreHeader) + sizeof(SaveSlotInfo) * slotIndex);
+    storeFile.write(reinterpret_cast<char*>(&this->slotInfos[slotIndex]), sizeof(SaveSlotInfo));
+    storeFile.seekp(this->records + slotIndex * SAVE_RECORD_LENGTH - this->data);
+    storeFile.write(this->records + slotIndex * SAVE_RECORD_LENGTH, SAVE_RECORD_LENGTH);
+    return storeFile.good();
+#else
+    // msync needs page aligned addresses
+    long pageSize = sysconf(_SC_PAGESIZE);
+    uintptr_t infoStart = reinterpret_cast<uintptr_t>(&this->slotInfos[slotIndex]) & ~(pageSize - 1);
+    uintptr_t recordStart = reinterpret_cast<uintptr_t>(this->records + slotIndex * SAVE_RECORD_LENGTH) & ~(pageSize - 1);
+    return msync(reinterpret_cast<void*>(infoStart), pageSize, MS_ASYNC) == 0 &&
+        msync(reinterpret_cast<void*>(recordStart), pageSize, MS_ASYNC) == 0;
+#endif
+}
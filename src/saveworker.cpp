@@ -0,0 +1,100 @@
+#include "saveworker.hpp"
+
+SaveWorker::SaveWorker(Persistence* persistence)
+{
+    this->persistence = persistence;
+
+    this->hasPendingSave = false;
+    this->isWriting = false;
+    this->hasResult = false;
+    this->isSaved = false;
+    this->isStopping = false;
+
+    this->thread = std::thread(&SaveWorker::run, this);
+}
+
+SaveWorker::~SaveWorker()
+{
+    // A requested save is still written before the game exits
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->isStopping = true;
+    }
+    this->condition.notify_one();
+    this->thread.join();
+
+    this->persistence = nullptr;
+}
+
+// Must be called from the thread that owns the board, the hook may be nullptr
+void SaveWorker::requestSave(const char* fileName, SavedHook hook)
+{
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->persistence->takeSnapshot(&this->pendingSnapshot);
+        this->pendingFileName = fileName;
+        this->pendingHook = hook;
+        this->hasPendingSave = true;
+    }
+    this->condition.notify_one();
+}
+
+// Returns true once per finished save, with whether it was saved
+bool SaveWorker::pollResult(bool* isSaved)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (!this->hasResult)
+    {
+        return false;
+    }
+
+    *isSaved = this->isSaved;
+    this->hasResult = false;
+    return true;
+}
+
+// A save is waiting, being written or not reported yet
+bool SaveWorker::getIsBusy()
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->hasPendingSave || this->isWriting || this->hasResult;
+}
+
+// Blocks until every requested save is on disk
+void SaveWorker::wait()
+{
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->idleCondition.wait(lock, [this] { return !this->hasPendingSave && !this->isWriting; });
+}
+
+void SaveWorker::run()
+{
+    std::unique_lock<std::mutex> lock(this->mutex);
+    while (true)
+    {
+        this->condition.wait(lock, [this] { return this->hasPendingSave || this->isStopping; });
+        if (!this->hasPendingSave)
+        {
+            return;
+        }
+
+        // Take the snapshot, so a new save can be requested while this one is written
+        std::swap(this->pendingSnapshot, this->writingSnapshot);
+        const char* fileName = this->pendingFileName;
+        SavedHook hook = this->pendingHook;
+        this->hasPendingSave = false;
+        this->isWriting = true;
+        lock.unlock();
+
+        string tempName = string(fileName) + ".tmp";
+        uint32_t checksum;
+        bool isSaved = Persistence::writeFile(tempName.c_str(), this->writingSnapshot, &checksum) &&
+            Persistence::replaceFile(tempName.c_str(), fileName) && (hook == nullptr || hook(checksum));
+
+        lock.lock();
+        this->isWriting = false;
+        this->isSaved = isSaved;
+        this->hasResult = true;
+        this->idleCondition.notify_all();
+    }
+}
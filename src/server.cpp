@@ -0,0 +1,453 @@
+#include "server.hpp"
+
+#ifdef __linux__
+
+#include <csignal>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+ServerWorker::ServerWorker(RuleVariant ruleVariant) : sessionPool(ruleVariant)
+{
+    this->epollDescriptor = -1;
+    this->eventDescriptor = -1;
+    this->isStopping = false;
+}
+
+ServerWorker::~ServerWorker()
+{
+    stop();
+}
+
+bool ServerWorker::start()
+{
+    this->epollDescriptor = epoll_create1(EPOLL_CLOEXEC);
+    this->eventDescriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (this->epollDescriptor == -1 || this->eventDescriptor == -1)
+    {
+        return false;
+    }
+
+    // The event descriptor is the only one without a connection
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.ptr = nullptr;
+    if (epoll_ctl(this->epollDescriptor, EPOLL_CTL_ADD, this->eventDescriptor, &event) == -1)
+    {
+        return false;
+    }
+
+    this->thread = std::thread(&ServerWorker::run, this);
+    return true;
+}
+
+void ServerWorker::stop()
+{
+    if (this->thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->isStopping = true;
+        }
+        uint64_t value = 1;
+        ssize_t result = write(this->eventDescriptor, &value, sizeof(value));
+        (void)result;
+        this->thread.join();
+    }
+
+    for (int fileDescriptor : this->pendingConnections)
+    {
+        ::close(fileDescriptor);
+    }
+    this->pendingConnections.clear();
+    if (this->eventDescriptor != -1)
+    {
+        ::close(this->eventDescriptor);
+        this->eventDescriptor = -1;
+    }
+    if (this->epollDescriptor != -1)
+    {
+        ::close(this->epollDescriptor);
+        this->epollDescriptor = -1;
+    }
+}
+
+// Called from the accepting thread, the worker owns the connection from here on
+void ServerWorker::addConnection(int fileDescriptor)
+{
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->pendingConnections.push_back(fileDescriptor);
+    }
+    uint64_t value = 1;
+    ssize_t result = write(this->eventDescriptor, &value, sizeof(value));
+    (void)result;
+}
+
+void ServerWorker::run()
+{
+    vector<ServerConnection*> connections;
+    epoll_event events[SERVER_MAX_EVENTS];
+    while (true)
+    {
+        int eventCount = epoll_wait(this->epollDescriptor, events, SERVER_MAX_EVENTS, -1);
+        if (eventCount == -1 && errno != EINTR)
+        {
+            break;
+        }
+
+        bool isStopping = false;
+        for (int i = 0; i < eventCount; i++)
+        {
+            ServerConnection* connection = static_cast<ServerConnection*>(events[i].data.ptr);
+            if (connection == nullptr)
+            {
+                uint64_t value;
+                ssize_t result = read(this->eventDescriptor, &value, sizeof(value));
+                (void)result;
+
+                std::lock_guard<std::mutex> lock(this->mutex);
+                isStopping = this->isStopping;
+                for (int fileDescriptor : this->pendingConnections)
+                {
+                    connection = new ServerConnection();
+                    connection->fileDescriptor = fileDescriptor;
+                    connection->outputOffset = 0;
+                    connection->isWaitingForOutput = false;
+
+                    epoll_event event = {};
+                    event.events = EPOLLIN;
+                    event.data.ptr = connection;
+                    if (epoll_ctl(this->epollDescriptor, EPOLL_CTL_ADD, fileDescriptor, &event) == -1)
+                    {
+                        ::close(fileDescriptor);
+                        delete connection;
+                        continue;
+                    }
+                    connections.push_back(connection);
+                }
+                this->pendingConnections.clear();
+                continue;
+            }
+
+            // A connection with unsent responses is not read until they are sent
+            bool isOpen = connection->fileDescriptor != -1;
+            if (isOpen && (events[i].events & EPOLLOUT))
+            {
+                isOpen = flushConnection(connection);
+            }
+            else if (isOpen && (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)))
+            {
+                isOpen = readConnection(connection) && flushConnection(connection);
+            }
+            if (!isOpen)
+            {
+                closeConnection(connection);
+            }
+        }
+
+        // Closed connections are only freed here, a later event in the same batch may still point to them
+        for (size_t i = 0; i < connections.size();)
+        {
+            if (connections[i]->fileDescriptor == -1)
+            {
+                delete connections[i];
+                connections[i] = connections.back();
+                connections.pop_back();
+            }
+            else
+            {
+                i++;
+            }
+        }
+
+        if (isStopping)
+        {
+            break;
+        }
+    }
+
+    for (ServerConnection* connection : connections)
+    {
+        closeConnection(connection);
+        delete connection;
+    }
+}
+
+// Handles every complete line in one read, returns false once the connection is closed
+bool ServerWorker::readConnection(ServerConnection* connection)
+{
+    char buffer[SERVER_READ_LENGTH];
+    ssize_t length = read(connection->fileDescriptor, buffer, sizeof(buffer));
+    if (length == -1)
+    {
+        return errno == EAGAIN || errno == EINTR;
+    }
+    if (length == 0)
+    {
+        return false;
+    }
+
+    connection->input.append(buffer, length);
+    size_t lineStart = 0;
+    while (true)
+    {
+        size_t lineEnd = connection->input.find('\n', lineStart);
+        if (lineEnd == string::npos)
+        {
+            break;
+        }
+        handleLine(connection, connection->input.substr(lineStart, lineEnd - lineStart));
+        lineStart = lineEnd + 1;
+    }
+    connection->input.erase(0, lineStart);
+    return connection->input.length() <= SERVER_MAX_LINE_LENGTH;
+}
+
+// Sends what the socket takes, the rest waits for EPOLLOUT
+bool ServerWorker::flushConnection(ServerConnection* connection)
+{
+    while (connection->outputOffset < connection->output.length())
+    {
+        ssize_t length = send(connection->fileDescriptor, connection->output.data() + connection->outputOffset,
+            connection->output.length() - connection->outputOffset, MSG_NOSIGNAL);
+        if (length == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno != EAGAIN)
+            {
+                return false;
+            }
+
+            connection->isWaitingForOutput = true;
+            epoll_event event = {};
+            event.events = EPOLLOUT;
+            event.data.ptr = connection;
+            return epoll_ctl(this->epollDescriptor, EPOLL_CTL_MOD, connection->fileDescriptor, &event) == 0;
+        }
+        connection->outputOffset += length;
+    }
+
+    connection->output.clear();
+    connection->outputOffset = 0;
+    if (!connection->isWaitingForOutput)
+    {
+        return true;
+    }
+
+    // Everything is sent, so the connection is read again
+    connection->isWaitingForOutput = false;
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.ptr = connection;
+    return epoll_ctl(this->epollDescriptor, EPOLL_CTL_MOD, connection->fileDescriptor, &event) == 0;
+}
+
+void ServerWorker::closeConnection(ServerConnection* connection)
+{
+    if (connection->fileDescriptor == -1)
+    {
+        return;
+    }
+
+    // Closing the descriptor also removes it from the epoll set
+    ::close(connection->fileDescriptor);
+    connection->fileDescriptor = -1;
+    for (GameSession* session : connection->sessions)
+    {
+        if (session != nullptr)
+        {
+            this->sessionPool.release(session);
+        }
+    }
+    connection->sessions.clear();
+    connection->freeSessions.clear();
+}
+
+void ServerWorker::handleLine(ServerConnection* connection, const string& line)
+{
+    std::istringstream args(line);
+    string command;
+    string response;
+    args >> command;
+
+    if (command == "open")
+    {
+        int sessionIndex;
+        if (connection->freeSessions.empty())
+        {
+            sessionIndex = connection->sessions.size();
+            connection->sessions.push_back(nullptr);
+        }
+        else
+        {
+            sessionIndex = connection->freeSessions.back();
+            connection->freeSessions.pop_back();
+        }
+        connection->sessions[sessionIndex] = this->sessionPool.acquire();
+        response = "ok " + std::to_string(sessionIndex);
+    }
+    else
+    {
+        // Every other command names its session first
+        bool isClose = command == "close";
+        string sessionText = command;
+        if (isClose)
+        {
+            args >> sessionText;
+        }
+
+        char* sessionEnd = nullptr;
+        unsigned long sessionIndex = strtoul(sessionText.c_str(), &sessionEnd, 10);
+        if (sessionText.empty() || *sessionEnd != '\0' || sessionIndex >= connection->sessions.size() || connection->sessions[sessionIndex] == nullptr)
+        {
+            response = "err unknown session";
+        }
+        else if (isClose)
+        {
+            this->sessionPool.release(connection->sessions[sessionIndex]);
+            connection->sessions[sessionIndex] = nullptr;
+            connection->freeSessions.push_back(sessionIndex);
+            response = "ok";
+        }
+        else if (!(args >> command) || !connection->sessions[sessionIndex]->handleCommand(command, args, &response))
+        {
+            response = "err unknown command";
+        }
+    }
+
+    connection->output += response;
+    connection->output += '\n';
+}
+
+GameServer::GameServer(RuleVariant ruleVariant, int workerCount)
+{
+    for (int i = 0; i < workerCount; i++)
+    {
+        this->workers.push_back(new ServerWorker(ruleVariant));
+    }
+}
+
+GameServer::~GameServer()
+{
+    for (ServerWorker* worker : this->workers)
+    {
+        delete worker;
+    }
+}
+
+int GameServer::run(const char* socketName)
+{
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (strlen(socketName) >= sizeof(address.sun_path))
+    {
+        std::cout << "Socket path is too long: " << socketName << std::endl;
+        return 1;
+    }
+    strcpy(address.sun_path, socketName);
+
+    // Signals are read from a descriptor, and blocked before the workers start so they inherit the mask
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    int signalDescriptor = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+
+    // A socket left over from a previous run would fail the bind
+    unlink(socketName);
+    int listenDescriptor = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int epollDescriptor = epoll_create1(EPOLL_CLOEXEC);
+    if (signalDescriptor == -1 || listenDescriptor == -1 || epollDescriptor == -1 ||
+        bind(listenDescriptor, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1 || listen(listenDescriptor, SOMAXCONN) == -1)
+    {
+        std::cout << "Unable to listen on " << socketName << std::endl;
+        return 1;
+    }
+
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = listenDescriptor;
+    epoll_ctl(epollDescriptor, EPOLL_CTL_ADD, listenDescriptor, &event);
+    event.data.fd = signalDescriptor;
+    epoll_ctl(epollDescriptor, EPOLL_CTL_ADD, signalDescriptor, &event);
+
+    for (ServerWorker* worker : this->workers)
+    {
+        if (!worker->start())
+        {
+            std::cout << "Unable to start the workers" << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "Listening on " << socketName << " with " << this->workers.size() << " workers" << std::endl;
+
+    size_t nextWorker = 0;
+    bool isRunning = true;
+    while (isRunning)
+    {
+        int eventCount = epoll_wait(epollDescriptor, &event, 1, -1);
+        if (eventCount == -1 && errno != EINTR)
+        {
+            break;
+        }
+        if (eventCount != 1)
+        {
+            continue;
+        }
+
+        if (event.data.fd == signalDescriptor)
+        {
+            isRunning = false;
+            continue;
+        }
+        while (true)
+        {
+            int fileDescriptor = accept4(listenDescriptor, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fileDescriptor == -1)
+            {
+                break;
+            }
+            this->workers[nextWorker]->addConnection(fileDescriptor);
+            nextWorker = (nextWorker + 1) % this->workers.size();
+        }
+    }
+
+    for (ServerWorker* worker : this->workers)
+    {
+        worker->stop();
+    }
+    ::close(epollDescriptor);
+    ::close(listenDescriptor);
+    ::close(signalDescriptor);
+    unlink(socketName);
+    return 0;
+}
+
+#else
+
+// Unix domain sockets and epoll are only used on Linux
+GameServer::GameServer(RuleVariant, int)
+{
+}
+
+GameServer::~GameServer()
+{
+}
+
+int GameServer::run(const char*)
+{
+    std::cout << "The server is only supported on Linux" << std::endl;
+    return 1;
+}
+
+#endif
@@ -0,0 +1,197 @@
+#include "session.hpp"
+#include "replay.hpp"
+
+#include <new>
+
+GameSession::GameSession(RuleVariant variant)
+    : logic(&this->board, nullptr, nullptr, &this->history)
+{
+    this->board.setRuleVariant(variant);
+    deal(1);
+}
+
+void GameSession::deal(uint32_t seed)
+{
+    // The board keeps its rules through a new game
+    this->board.onNewGame();
+    this->board.dealCards(seed);
+    this->history.clear();
+    this->keyframes.clear();
+    this->keyframeLengths.clear();
+    this->keyframeRedealCounts.clear();
+    addKeyframe();
+}
+
+bool GameSession::applyMove(const Move& move)
+{
+    if (!this->logic.applyMove(move))
+    {
+        return false;
+    }
+    if (this->history.getLength() % SESSION_KEYFRAME_INTERVAL == 0)
+    {
+        addKeyframe();
+    }
+    return true;
+}
+
+// Loads the last keyframe before the previous position and replays the moves after it
+// Fails and leaves the game as it was if the keyframe does not decode
+bool GameSession::undo()
+{
+    int moveCount = this->history.getLength() - 1;
+    if (moveCount < 0)
+    {
+        return false;
+    }
+
+    int keyframeIndex = moveCount / SESSION_KEYFRAME_INTERVAL;
+    int keyframeMoveCount = keyframeIndex * SESSION_KEYFRAME_INTERVAL;
+    Board previousBoard = this->board;
+    this->board.onNewGame();
+    this->board.setSeed(previousBoard.getSeed());
+    if (!Persistence::readRecord(&this->board, this->keyframes.data() + keyframeIndex * V1_MAX_LENGTH, this->keyframeLengths[keyframeIndex]))
+    {
+        this->board = previousBoard;
+        return false;
+    }
+    this->board.setRedealCount(this->keyframeRedealCounts[keyframeIndex]);
+
+    this->undoMoves.clear();
+    for (int i = keyframeMoveCount; i < moveCount; i++)
+    {
+        this->undoMoves.push_back(this->history.getMove(i));
+    }
+    this->history.truncate(keyframeMoveCount);
+    // The keyframe of the position that was undone, if it had one
+    this->keyframes.resize((keyframeIndex + 1) * V1_MAX_LENGTH);
+    this->keyframeLengths.resize(keyframeIndex + 1);
+    this->keyframeRedealCounts.resize(keyframeIndex + 1);
+
+    for (const Move& move : this->undoMoves)
+    {
+        this->logic.applyMove(move);
+    }
+    return true;
+}
+
+int GameSession::generateMoves(Move* moves)
+{
+    return this->logic.generateMoves(moves);
+}
+
+bool GameSession::isGameWon()
+{
+    return this->logic.isGameWon();
+}
+
+const Board* GameSession::getBoard()
+{
+    return &this->board;
+}
+
+void GameSession::addKeyframe()
+{
+    int keyframeIndex = this->keyframes.size();
+    this->keyframes.resize(keyframeIndex + V1_MAX_LENGTH);
+    this->keyframeLengths.push_back(Persistence::writeRecord(this->board, this->keyframes.data() + keyframeIndex));
+    this->keyframeRedealCounts.push_back(this->board.getRedealCount());
+}
+
+bool GameSession::handleCommand(const string& command, std::istream& args, string* response)
+{
+    if (command == "deal")
+    {
+        uint32_t seed;
+        if (!(args >> seed))
+        {
+            *response = "err expected a seed";
+            return true;
+        }
+        deal(seed);
+        *response = "ok";
+    }
+    else if (command == "play")
+    {
+        string text;
+        Move move;
+        if (!(args >> text) || !parseMove(text, &move))
+        {
+            *response = "err expected a move";
+        }
+        else if (!applyMove(move))
+        {
+            *response = "err illegal move";
+        }
+        else
+        {
+            *response = isGameWon() ? "ok won" : "ok";
+        }
+    }
+    else if (command == "moves")
+    {
+        Move moves[MAX_MOVES];
+        int moveCount = generateMoves(moves);
+        *response = "ok";
+        for (int i = 0; i < moveCount; i++)
+        {
+            *response += " " + formatMove(moves[i]);
+        }
+    }
+    else if (command == "undo")
+    {
+        *response = undo() ? "ok" : "err nothing to undo";
+    }
+    else if (command == "state")
+    {
+        *response = "ok " + formatBoard(this->board);
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+SessionPool::SessionPool(RuleVariant ruleVariant)
+{
+    this->ruleVariant = ruleVariant;
+    this->slabLength = SESSION_SLAB_LENGTH;
+}
+
+SessionPool::~SessionPool()
+{
+    for (size_t i = 0; i < this->slabs.size(); i++)
+    {
+        int sessionCount = i + 1 < this->slabs.size() ? SESSION_SLAB_LENGTH : this->slabLength;
+        for (int j = 0; j < sessionCount; j++)
+        {
+            this->slabs[i][j].~GameSession();
+        }
+        ::operator delete(this->slabs[i]);
+    }
+}
+
+// A released session starts over from the same deal a new one gets
+GameSession* SessionPool::acquire()
+{
+    if (!this->freeSessions.empty())
+    {
+        GameSession* session = this->freeSessions.back();
+        this->freeSessions.pop_back();
+        session->deal(1);
+        return session;
+    }
+
+    if (this->slabLength == SESSION_SLAB_LENGTH)
+    {
+        this->slabs.push_back(static_cast<GameSession*>(::operator new(SESSION_SLAB_LENGTH * sizeof(GameSession))));
+        this->slabLength = 0;
+    }
+    return new (&this->slabs.back()[this->slabLength++]) GameSession(this->ruleVariant);
+}
+
+void SessionPool::release(GameSession* session)
+{
+    this->freeSessions.push_back(session);
+}
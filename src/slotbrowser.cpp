@@ -0,0 +1,110 @@
+#include "slotbrowser.hpp"
+
+// In RuleVariant order
+static const char* RULE_VARIANT_NAMES[RULE_VARIANT_COUNT] = { "Draw 1", "Draw 3", "Vegas Draw 1", "Vegas Draw 3" };
+
+SlotBrowser::SlotBrowser(SaveStore* store)
+{
+    this->store = store;
+    this->prevMenuState = GameState::MAIN_MENU;
+    this->topRowIndex = 0;
+    this->selectedRowIndex = 0;
+}
+
+void SlotBrowser::shiftRow(bool isDown)
+{
+    if (isDown && this->selectedRowIndex < SLOT_BROWSER_ROW_COUNT - 1)
+    {
+        this->selectedRowIndex++;
+    }
+    else if (!isDown && this->selectedRowIndex > 0)
+    {
+        this->selectedRowIndex--;
+    }
+    clampTopRow();
+}
+
+void SlotBrowser::shiftPage(bool isDown)
+{
+    this->selectedRowIndex += isDown ? SLOT_BROWSER_VISIBLE_ROWS : -SLOT_BROWSER_VISIBLE_ROWS;
+    if (this->selectedRowIndex < 0)
+    {
+        this->selectedRowIndex = 0;
+    }
+    else if (this->selectedRowIndex >= SLOT_BROWSER_ROW_COUNT)
+    {
+        this->selectedRowIndex = SLOT_BROWSER_ROW_COUNT - 1;
+    }
+    clampTopRow();
+}
+
+void SlotBrowser::render()
+{
+    bool isSaving = this->prevMenuState == GameState::GAME_MENU;
+    string title = isSaving ? "Save Game" : "Load Game";
+    monoColorPrint(ColorPair::MAGENTA, 2, (MIN_WIDTH - title.length()) / 2, title);
+
+    // Only the visible rows are read from the store
+    for (int i = 0; i < SLOT_BROWSER_VISIBLE_ROWS && this->topRowIndex + i < SLOT_BROWSER_ROW_COUNT; i++)
+    {
+        int rowIndex = this->topRowIndex + i;
+        bool isSelected = rowIndex == this->selectedRowIndex;
+        string text = (isSelected ? "> " : "  ") + getRowText(rowIndex) + (isSelected ? " <" : "");
+        monoColorPrint(isSelected ? ColorPair::YELLOW : ColorPair::CYAN, 4 + i, 4, text);
+    }
+}
+
+int SlotBrowser::getSelectedRow()
+{
+    return this->selectedRowIndex;
+}
+
+GameState SlotBrowser::getPrevMenuState()
+{
+    return this->prevMenuState;
+}
+
+void SlotBrowser::setPrevMenuState(GameState state)
+{
+    this->prevMenuState = state;
+}
+
+void SlotBrowser::clampTopRow()
+{
+    if (this->selectedRowIndex < this->topRowIndex)
+    {
+        this->topRowIndex = this->selectedRowIndex;
+    }
+    else if (this->selectedRowIndex >= this->topRowIndex + SLOT_BROWSER_VISIBLE_ROWS)
+    {
+        this->topRowIndex = this->selectedRowIndex - SLOT_BROWSER_VISIBLE_ROWS + 1;
+    }
+}
+
+string SlotBrowser::getRowText(int rowIndex)
+{
+    if (rowIndex == 0)
+    {
+        return "File   " + string(SAVEFILE_NAME);
+    }
+
+    char text[MIN_WIDTH];
+    const SaveSlotInfo* slotInfo = this->store->getSlotInfo(rowIndex - 1);
+    if (slotInfo == nullptr)
+    {
+        snprintf(text, sizeof(text), "Slot %04d   Unavailable", rowIndex);
+    }
+    else if (slotInfo->timestamp == 0)
+    {
+        snprintf(text, sizeof(text), "Slot %04d   Empty", rowIndex);
+    }
+    else
+    {
+        char date[20];
+        time_t timestamp = static_cast<time_t>(slotInfo->timestamp);
+        strftime(date, sizeof(date), "%Y-%m-%d %H:%M", localtime(&timestamp));
+        const char* ruleName = slotInfo->ruleVariant < RULE_VARIANT_COUNT ? RULE_VARIANT_NAMES[slotInfo->ruleVariant] : "Unknown rules";
+        snprintf(text, sizeof(text), "Slot %04d   %s   Moves %5d   %s", rowIndex, date, slotInfo->moves, ruleName);
+    }
+    return string(text);
+}
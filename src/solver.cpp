@@ -0,0 +1,146 @@
+#include "solver.hpp"
+#include "bitboard.hpp"
+#include "canonical.hpp"
+
+#include <algorithm>
+
+int getMoveLowerBound(const Board& board, int drawCount)
+{
+    int lowerBound = 0;
+    for (int i = 0; i < STACK_COUNT; i++)
+    {
+        lowerBound += board.getStackLength(i) > 0 ? board.getHiddenCardCount(i) + 1 : 0;
+    }
+    int stockLength = board.getRemainingUnusedCardCount();
+    lowerBound += stockLength + board.getWasteLength();
+    lowerBound += (stockLength + drawCount - 1) / drawCount;
+    return lowerBound;
+}
+
+// Piles a move reads or changes, a chain of stack cards may go to any foundation
+static uint32_t getMovePiles(const Move& move)
+{
+    constexpr uint32_t FOUNDATION_PILES = ((1 << FOUNDATION_COUNT) - 1) << FIRST_FOUNDATION_PILE;
+    uint32_t piles = 1 << move.from | 1 << move.to;
+    return isStackPile(move.from) && isFoundationPile(move.to) ? piles | FOUNDATION_PILES : piles;
+}
+
+static int getMoveOrder(const Move& move)
+{
+    return move.from * PILE_COUNT + move.to;
+}
+
+EndgameSolver::EndgameSolver(RuleVariant ruleVariant)
+{
+    this->rules = getRuleSet(ruleVariant);
+    this->boards.resize(ENDGAME_MAX_MOVES + 1);
+    this->path.resize(ENDGAME_MAX_MOVES);
+    this->nodeCount = 0;
+    this->nodeBudget = 0;
+}
+
+// The board's draw count is the one of the rules
+EndgameResult EndgameSolver::solve(const Board& board, uint64_t nodeBudget)
+{
+    this->boards[0] = board;
+    // Entries of an earlier position may be of another deal
+    this->table.assign(static_cast<size_t>(1) << ENDGAME_TABLE_BITS, TableEntry());
+    this->nodeCount = 0;
+    this->nodeBudget = nodeBudget;
+
+    EndgameResult result = {};
+    int bound = getMoveLowerBound(board, this->rules->drawCount);
+    while (bound <= ENDGAME_MAX_MOVES)
+    {
+        int nextBound = INT32_MAX;
+        EndgameSearchResult searchResult = search(0, bound, &nextBound);
+        if (searchResult == EndgameSearchResult::ENDGAME_WON)
+        {
+            result.isWon = true;
+            result.moves.assign(this->path.begin(), this->path.begin() + bound);
+            break;
+        }
+        if (searchResult == EndgameSearchResult::ENDGAME_OUT_OF_BUDGET)
+        {
+            break;
+        }
+        if (nextBound == INT32_MAX)
+        {
+            result.hasNoWin = true;
+            break;
+        }
+        bound = nextBound;
+    }
+
+    result.moveCount = result.isWon ? result.moves.size() : bound;
+    result.nodeCount = this->nodeCount;
+    return result;
+}
+
+// A win is found only at exactly the bound, every shorter bound was searched before
+EndgameSearchResult EndgameSolver::search(int ply, int bound, int* nextBound)
+{
+    const Board& board = this->boards[ply];
+    int lowerBound = getMoveLowerBound(board, this->rules->drawCount);
+    if (lowerBound == 0)
+    {
+        return EndgameSearchResult::ENDGAME_WON;
+    }
+    if (ply + lowerBound > bound)
+    {
+        *nextBound = std::min(*nextBound, ply + lowerBound);
+        return EndgameSearchResult::ENDGAME_NOT_WON;
+    }
+    if (++this->nodeCount > this->nodeBudget)
+    {
+        return EndgameSearchResult::ENDGAME_OUT_OF_BUDGET;
+    }
+    if (!checkTable(hashCanonicalPosition(board), ply, bound, nextBound))
+    {
+        return EndgameSearchResult::ENDGAME_NOT_WON;
+    }
+
+    Move moves[MAX_MOVES];
+    Bitboard bitboard;
+    int moveCount = this->rules->generateMoves(&this->boards[ply], &bitboard, moves);
+    Board* nextBoard = &this->boards[ply + 1];
+    // Moves on separate piles give the same position in either order, so only the order with the lower move first is searched
+    uint32_t lastPiles = ply > 0 ? getMovePiles(this->path[ply - 1]) : 0;
+    int lastOrder = ply > 0 ? getMoveOrder(this->path[ply - 1]) : 0;
+    for (int i = 0; i < moveCount; i++)
+    {
+        if (ply > 0 && (getMovePiles(moves[i]) & lastPiles) == 0 && getMoveOrder(moves[i]) < lastOrder)
+        {
+            continue;
+        }
+
+        *nextBoard = board;
+        this->rules->applyMove(nextBoard, moves[i]);
+        this->path[ply] = moves[i];
+        EndgameSearchResult searchResult = search(ply + 1, bound, nextBound);
+        if (searchResult != EndgameSearchResult::ENDGAME_NOT_WON)
+        {
+            return searchResult;
+        }
+    }
+    return EndgameSearchResult::ENDGAME_NOT_WON;
+}
+
+/*
+Whether the position has to be searched with this many moves left, and if so the table keeps it
+A position skipped for an earlier search may still win with one move more than that search had, so that bounds the next search
+*/
+bool EndgameSolver::checkTable(uint64_t hash, int ply, int bound, int* nextBound)
+{
+    TableEntry* entry = &this->table[hash & ((static_cast<uint64_t>(1) << ENDGAME_TABLE_BITS) - 1)];
+    int remainingMoves = bound - ply;
+    if (entry->hash == hash && entry->remainingMoves >= remainingMoves)
+    {
+        *nextBound = std::min(*nextBound, ply + entry->remainingMoves + 1);
+        return false;
+    }
+
+    entry->hash = hash;
+    entry->remainingMoves = remainingMoves;
+    return true;
+}
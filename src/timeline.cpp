@@ -0,0 +1,104 @@
+#include "timeline.hpp"
+
+Timeline::Timeline()
+    : logic(&this->board, nullptr, nullptr, nullptr)
+{
+    this->seed = 0;
+    this->position = 0;
+}
+
+// Replays the whole game once to take its keyframes, moves after the first illegal one are dropped
+// Returns the number of moves kept
+int Timeline::load(uint32_t seed, RuleVariant variant, const Move* moves, int moveCount)
+{
+    this->seed = seed;
+    this->moves.clear();
+    this->keyframes.clear();
+    this->keyframeLengths.clear();
+    this->keyframeRedealCounts.clear();
+
+    this->board.onNewGame();
+    this->board.setRuleVariant(variant);
+    this->board.dealCards(seed);
+    addKeyframe();
+
+    for (int i = 0; i < moveCount && this->logic.applyMove(moves[i]); i++)
+    {
+        this->moves.push_back(moves[i]);
+        if (this->moves.size() % KEYFRAME_INTERVAL == 0)
+        {
+            addKeyframe();
+        }
+    }
+    this->position = this->moves.size();
+    return this->position;
+}
+
+// Positions the board after the given number of moves
+void Timeline::seek(int position)
+{
+    if (position < 0)
+    {
+        position = 0;
+    }
+    else if (position > getLength())
+    {
+        position = getLength();
+    }
+
+    // Moving forward within the same keyframe interval just replays the moves in between
+    int keyframeIndex = position / KEYFRAME_INTERVAL;
+    if (position < this->position || this->position < keyframeIndex * KEYFRAME_INTERVAL)
+    {
+        loadKeyframe(keyframeIndex);
+    }
+    for (; this->position < position; this->position++)
+    {
+        this->logic.applyMove(this->moves[this->position]);
+    }
+}
+
+int Timeline::getPosition()
+{
+    return this->position;
+}
+
+int Timeline::getLength()
+{
+    return this->moves.size();
+}
+
+const Move& Timeline::getMove(int moveIndex)
+{
+    return this->moves[moveIndex];
+}
+
+Board* Timeline::getBoard()
+{
+    return &this->board;
+}
+
+void Timeline::addKeyframe()
+{
+    int keyframeIndex = this->keyframes.size();
+    this->keyframes.resize(keyframeIndex + V1_MAX_LENGTH);
+    this->keyframeLengths.push_back(Persistence::writeRecord(this->board, this->keyframes.data() + keyframeIndex));
+    this->keyframeRedealCounts.push_back(this->board.getRedealCount());
+}
+
+void Timeline::loadKeyframe(int keyframeIndex)
+{
+    this->board.onNewGame();
+    this->board.setSeed(this->seed);
+    if (Persistence::readRecord(&this->board, this->keyframes.data() + keyframeIndex * V1_MAX_LENGTH, this->keyframeLengths[keyframeIndex]))
+    {
+        this->board.setRedealCount(this->keyframeRedealCounts[keyframeIndex]);
+        this->position = keyframeIndex * KEYFRAME_INTERVAL;
+        return;
+    }
+
+    // A keyframe that does not decode is skipped, the moves are replayed from the deal instead
+    this->board.onNewGame();
+    this->board.dealCards(this->seed);
+    this->position = 0;
+}
@@ -0,0 +1,258 @@
+#include "tournament.hpp"
+#include "bitboard.hpp"
+#include "canonical.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <thread>
+#ifndef _WIN32
+    #include <ctime>
+#endif
+
+// CPU time of the calling thread, so games on a busy machine are still measured fairly
+static uint64_t getThreadMicroseconds()
+{
+#ifdef _WIN32
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#else
+    timespec time;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return static_cast<uint64_t>(time.tv_sec) * 1000000 + time.tv_nsec / 1000;
+#endif
+}
+
+static bool isBoardWon(const Board& board)
+{
+    for (int i = 0; i < FOUNDATION_COUNT; i++)
+    {
+        if (board.getFoundationLength(i) != MAX_VALUE)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+TournamentPlayer::TournamentPlayer(RuleVariant ruleVariant)
+{
+    this->rules = getRuleSet(ruleVariant);
+    this->board.setRuleVariant(ruleVariant);
+}
+
+DealResult TournamentPlayer::play(Strategy strategy, uint32_t seed)
+{
+    uint64_t startTime = getThreadMicroseconds();
+    // Rollouts of a deal are the same whichever thread plays it
+    this->rng.seed(seed);
+
+    this->board.onNewGame();
+    this->board.dealCards(seed);
+    this->seenPositions.clear();
+    this->seenPositions.insert(hashCanonicalPosition(this->board));
+
+    Bitboard bitboard;
+    int candidates[MAX_MOVES];
+    int moveCount = 0;
+    int bestScore = scorePosition(this->board);
+    int lastProgressMove = 0;
+    while (moveCount < TOURNAMENT_MAX_MOVES && moveCount - lastProgressMove < TOURNAMENT_STALL_MOVES && !isBoardWon(this->board))
+    {
+        int legalMoveCount = this->rules->generateMoves(&this->board, &bitboard, this->moves);
+        int candidateCount = 0;
+        for (int i = 0; i < legalMoveCount; i++)
+        {
+            this->nextBoards[i] = this->board;
+            this->rules->applyMove(&this->nextBoards[i], this->moves[i]);
+            if (this->seenPositions.count(hashCanonicalPosition(this->nextBoards[i])) == 0)
+            {
+                candidates[candidateCount++] = i;
+            }
+        }
+        if (candidateCount == 0)
+        {
+            break;
+        }
+
+        this->board = this->nextBoards[chooseMove(strategy, candidates, candidateCount)];
+        this->seenPositions.insert(hashCanonicalPosition(this->board));
+        moveCount++;
+        if (scorePosition(this->board) > bestScore)
+        {
+            bestScore = scorePosition(this->board);
+            lastProgressMove = moveCount;
+        }
+    }
+
+    DealResult result = { isBoardWon(this->board), static_cast<uint16_t>(moveCount), static_cast<uint32_t>(getThreadMicroseconds() - startTime) };
+    return result;
+}
+
+// Ties go to the earlier move, so foundation moves are preferred
+// Shuffling cards between stacks wins nothing by itself, so it loses ties to a draw
+int TournamentPlayer::chooseMove(Strategy strategy, const int* candidates, int candidateCount)
+{
+    int bestIndex = candidates[0];
+    int bestScore = INT32_MIN;
+    for (int i = 0; i < candidateCount; i++)
+    {
+        const Board& nextBoard = this->nextBoards[candidates[i]];
+        int score;
+        switch (strategy)
+        {
+        case Strategy::ROLLOUT_STRATEGY:
+            score = scoreRollout(nextBoard);
+            break;
+        case Strategy::SEARCH_STRATEGY:
+            score = this->search.scoreBestLine(nextBoard, this->rules, SEARCH_NODE_BUDGET);
+            break;
+        default:
+            score = isBoardWon(nextBoard) ? INT32_MAX - 1 : scorePosition(nextBoard);
+            break;
+        }
+        if (isStackPile(this->moves[candidates[i]].from) && isStackPile(this->moves[candidates[i]].to))
+        {
+            score--;
+        }
+
+        if (score > bestScore)
+        {
+            bestScore = score;
+            bestIndex = candidates[i];
+        }
+    }
+    return bestIndex;
+}
+
+// Total score at the end of random games, taking a move to a foundation whenever there is one
+int TournamentPlayer::scoreRollout(const Board& board)
+{
+    Board rolloutBoard;
+    Move rolloutMoves[MAX_MOVES];
+    Bitboard bitboard;
+    int totalScore = 0;
+    for (int i = 0; i < ROLLOUT_COUNT; i++)
+    {
+        rolloutBoard = board;
+        for (int j = 0; j < ROLLOUT_LENGTH && !isBoardWon(rolloutBoard); j++)
+        {
+            int moveCount = this->rules->generateMoves(&rolloutBoard, &bitboard, rolloutMoves);
+            if (moveCount == 0)
+            {
+                break;
+            }
+            int moveIndex = isFoundationPile(rolloutMoves[0].to) ? 0 : this->rng() % moveCount;
+            this->rules->applyMove(&rolloutBoard, rolloutMoves[moveIndex]);
+        }
+        totalScore += isBoardWon(rolloutBoard) ? 1 << 16 : scorePosition(rolloutBoard);
+    }
+    return totalScore;
+}
+
+Tournament::Tournament(RuleVariant ruleVariant, int dealCount, int threadCount)
+{
+    this->ruleVariant = ruleVariant;
+    this->dealCount = dealCount;
+    this->threadCount = threadCount;
+    this->seconds = 0;
+    this->nextDeal = 0;
+}
+
+void Tournament::run()
+{
+    for (int i = 0; i < STRATEGY_COUNT; i++)
+    {
+        this->results[i].assign(this->dealCount, DealResult());
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+    this->nextDeal = 0;
+    vector<std::thread> threads;
+    for (int i = 0; i < this->threadCount; i++)
+    {
+        threads.push_back(std::thread(&Tournament::runThread, this));
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    this->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+// Deal i is seed i + 1, each result slot is written by exactly one thread
+void Tournament::runThread()
+{
+    TournamentPlayer player(this->ruleVariant);
+    while (true)
+    {
+        int firstDeal = this->nextDeal.fetch_add(TOURNAMENT_DEAL_BATCH);
+        if (firstDeal >= this->dealCount)
+        {
+            return;
+        }
+
+        int lastDeal = std::min(firstDeal + TOURNAMENT_DEAL_BATCH, this->dealCount);
+        for (int i = firstDeal; i < lastDeal; i++)
+        {
+            for (int j = 0; j < STRATEGY_COUNT; j++)
+            {
+                this->results[j][i] = player.play(static_cast<Strategy>(j), i + 1);
+            }
+        }
+    }
+}
+
+void Tournament::printReport()
+{
+    char line[128];
+    std::cout << this->dealCount << " deals on " << this->threadCount << " threads in " << this->seconds << "s" << std::endl;
+    std::cout << "Strategy    Win rate  Moves (won)  Moves (all)  CPU ms/deal" << std::endl;
+    for (int i = 0; i < STRATEGY_COUNT; i++)
+    {
+        uint64_t wins = 0;
+        uint64_t wonMoves = 0;
+        uint64_t allMoves = 0;
+        uint64_t microseconds = 0;
+        for (const DealResult& result : this->results[i])
+        {
+            wins += result.isWon ? 1 : 0;
+            wonMoves += result.isWon ? result.moveCount : 0;
+            allMoves += result.moveCount;
+            microseconds += result.microseconds;
+        }
+        snprintf(line, sizeof(line), "%-10s %8.2f%% %12.1f %12.1f %12.3f", STRATEGY_NAMES[i], 100.0 * wins / this->dealCount,
+            wins > 0 ? static_cast<double>(wonMoves) / wins : 0.0, static_cast<double>(allMoves) / this->dealCount, microseconds / 1000.0 / this->dealCount);
+        std::cout << line << std::endl;
+    }
+
+    // Deals only one of the two strategies won decide which is better, z above 2 is unlikely to be chance
+    std::cout << std::endl << "Paired      Only A won  Only B won      z  Both won  A shorter  B shorter" << std::endl;
+    for (int a = 0; a < STRATEGY_COUNT; a++)
+    {
+        for (int b = a + 1; b < STRATEGY_COUNT; b++)
+        {
+            int onlyA = 0;
+            int onlyB = 0;
+            int bothWon = 0;
+            int shorterA = 0;
+            int shorterB = 0;
+            for (int i = 0; i < this->dealCount; i++)
+            {
+                const DealResult& resultA = this->results[a][i];
+                const DealResult& resultB = this->results[b][i];
+                onlyA += resultA.isWon && !resultB.isWon ? 1 : 0;
+                onlyB += !resultA.isWon && resultB.isWon ? 1 : 0;
+                if (resultA.isWon && resultB.isWon)
+                {
+                    bothWon++;
+                    shorterA += resultA.moveCount < resultB.moveCount ? 1 : 0;
+                    shorterB += resultB.moveCount < resultA.moveCount ? 1 : 0;
+                }
+            }
+
+            double z = onlyA + onlyB > 0 ? (onlyA - onlyB) / std::sqrt(static_cast<double>(onlyA + onlyB)) : 0.0;
+            string pair = string(STRATEGY_NAMES[a]).substr(0, 1) + " vs " + string(STRATEGY_NAMES[b]).substr(0, 1);
+            snprintf(line, sizeof(line), "%-10s %11d %11d %6.2f %9d %10d %10d", pair.c_str(), onlyA, onlyB, z, bothWon, shorterA, shorterB);
+            std::cout << line << std::endl;
+        }
+    }
+}